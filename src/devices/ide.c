@@ -50,6 +50,11 @@
 #define CMD_READ_SECTOR_RETRY 0x20      /* READ SECTOR with retries. */
 #define CMD_WRITE_SECTOR_RETRY 0x30     /* WRITE SECTOR with retries. */
 
+/* Longest wait for a command's completion interrupt, in timer
+   ticks.  A controller that stays silent this long is treated as
+   failed rather than hanging its caller forever. */
+#define COMPLETION_TIMEOUT (10 * TIMER_FREQ)
+
 /* An ATA device. */
 struct ata_disk
   {
@@ -273,8 +278,8 @@ identify_ata_device (struct ata_disk *d)
      into our buffer. */
   select_device_wait (d);
   issue_pio_command (c, CMD_IDENTIFY_DEVICE);
-  sema_down (&c->completion_wait);
-  if (!wait_while_busy (d))
+  if (!sema_down_timeout (&c->completion_wait, COMPLETION_TIMEOUT)
+      || !wait_while_busy (d))
     {
       d->is_ata = false;
       return;
@@ -349,7 +354,8 @@ ide_read (void *d_, block_sector_t sec_no, void *buffer)
   lock_acquire (&c->lock);
   select_sector (d, sec_no);
   issue_pio_command (c, CMD_READ_SECTOR_RETRY);
-  sema_down (&c->completion_wait);
+  if (!sema_down_timeout (&c->completion_wait, COMPLETION_TIMEOUT))
+    PANIC ("%s: disk read timed out, sector=%"PRDSNu, d->name, sec_no);
   if (!wait_while_busy (d))
     PANIC ("%s: disk read failed, sector=%"PRDSNu, d->name, sec_no);
   input_sector (c, buffer);
@@ -372,7 +378,8 @@ ide_write (void *d_, block_sector_t sec_no, const void *buffer)
   if (!wait_while_busy (d))
     PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
   output_sector (c, buffer);
-  sema_down (&c->completion_wait);
+  if (!sema_down_timeout (&c->completion_wait, COMPLETION_TIMEOUT))
+    PANIC ("%s: disk write timed out, sector=%"PRDSNu, d->name, sec_no);
   lock_release (&c->lock);
 }
 
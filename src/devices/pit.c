@@ -81,3 +81,60 @@ pit_configure_channel (int channel, int mode, int frequency)
   outb (PIT_PORT_COUNTER (channel), count >> 8);
   intr_set_level (old_level);
 }
+
+/* Counter value loaded by the last pit_configure_oneshot(). */
+static uint32_t oneshot_count;
+
+/* Configures channel 0 in mode 0 ("interrupt on terminal
+   count"), so that it raises a single interrupt after PERIODS
+   periods of a FREQUENCY Hz clock instead of a periodic one.
+   The 16-bit counter can only cover about 55 ms, so fewer
+   periods may be programmed than requested.  Returns the number
+   of periods actually programmed, which is at least 1.
+
+   Use pit_configure_channel() to go back to periodic mode. */
+int
+pit_configure_oneshot (int frequency, int periods)
+{
+  uint32_t period_count;
+  int max_periods;
+  enum intr_level old_level;
+
+  ASSERT (frequency >= 19 && frequency <= PIT_HZ);
+  ASSERT (periods > 0);
+
+  period_count = (PIT_HZ + frequency / 2) / frequency;
+  max_periods = UINT16_MAX / period_count;
+  if (periods > max_periods)
+    periods = max_periods;
+
+  old_level = intr_disable ();
+  oneshot_count = period_count * periods;
+  outb (PIT_PORT_CONTROL, 0x30);
+  outb (PIT_PORT_COUNTER (0), oneshot_count);
+  outb (PIT_PORT_COUNTER (0), oneshot_count >> 8);
+  intr_set_level (old_level);
+
+  return periods;
+}
+
+/* Returns the number of whole periods of a FREQUENCY Hz clock
+   that have elapsed since the last pit_configure_oneshot().
+   After the one-shot expires the counter keeps running, so the
+   result is only meaningful before the interrupt arrives. */
+int
+pit_oneshot_elapsed (int frequency)
+{
+  uint32_t period_count = (PIT_HZ + frequency / 2) / frequency;
+  uint16_t count;
+  enum intr_level old_level;
+
+  /* Latch channel 0's counter, then read it low byte first. */
+  old_level = intr_disable ();
+  outb (PIT_PORT_CONTROL, 0x00);
+  count = inb (PIT_PORT_COUNTER (0));
+  count |= inb (PIT_PORT_COUNTER (0)) << 8;
+  intr_set_level (old_level);
+
+  return ((oneshot_count - count) & 0xffff) / period_count;
+}
@@ -4,5 +4,7 @@
 #include <stdint.h>
 
 void pit_configure_channel (int channel, int mode, int frequency);
+int pit_configure_oneshot (int frequency, int periods);
+int pit_oneshot_elapsed (int frequency);
 
 #endif /* devices/pit.h */
@@ -5,9 +5,13 @@
 #include "devices/serial.h"
 #include "devices/timer.h"
 #include "threads/io.h"
+#include "threads/lockprof.h"
 #include "threads/thread.h"
+#include "threads/trace.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/exception.h"
+#include "userprog/syscall.h"
 #endif
 #ifdef FILESYS
 #include "devices/block.h"
@@ -130,6 +134,11 @@ print_stats (void)
 {
   timer_print_stats ();
   thread_print_stats ();
+  workqueue_print_stats ();
+  if (lockprof_enabled)
+    lockprof_print_stats ();
+  if (trace_enabled)
+    trace_dump ();
 #ifdef FILESYS
   block_print_stats ();
 #endif
@@ -137,5 +146,7 @@ print_stats (void)
   kbd_print_stats ();
 #ifdef USERPROG
   exception_print_stats ();
+  if (syscall_profile)
+    syscall_print_stats ();
 #endif
 }
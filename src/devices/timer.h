@@ -1,11 +1,19 @@
 #ifndef DEVICES_TIMER_H
 #define DEVICES_TIMER_H
 
+#include <list.h>
 #include <round.h>
+#include <stdbool.h>
 #include <stdint.h>
 
-/* Number of timer interrupts per second. */
-#define TIMER_FREQ 100
+/* Number of timer interrupts per second.  Chosen at boot with
+   kernel command-line option "-hz=N", so TIMER_FREQ is an
+   ordinary expression and cannot be used in #if. */
+#define TIMER_FREQ timer_freq
+#define TIMER_FREQ_DEFAULT 100
+#define TIMER_FREQ_MIN 19               /* 8254 counter limit. */
+#define TIMER_FREQ_MAX 1000             /* Above this, ticks cost too much. */
+extern int timer_freq;
 
 void timer_init (void);
 void timer_calibrate (void);
@@ -19,11 +27,42 @@ void timer_msleep (int64_t milliseconds);
 void timer_usleep (int64_t microseconds);
 void timer_nsleep (int64_t nanoseconds);
 
+/* Sleeps that another thread may cut short. */
+struct thread;
+void timer_block_until (int64_t deadline);
+void timer_wake (struct thread *);
+
+/* Waits on other objects that give up at a deadline. */
+bool timer_block_timeout (int64_t deadline);
+
+/* Timer callbacks.  See timer_add(). */
+typedef void timer_func (void *aux);
+
+struct timer
+  {
+    struct list_elem elem;      /* Element in a timer wheel slot. */
+    timer_func *func;           /* Function to call. */
+    void *aux;                  /* Argument to pass to FUNC. */
+    int64_t expires;            /* Tick at which to call FUNC. */
+    bool pending;               /* Added, and not fired or cancelled? */
+  };
+
+void timer_setup (struct timer *);
+void timer_add (struct timer *, timer_func *, void *aux, int64_t expires);
+bool timer_cancel (struct timer *);
+bool timer_pending (const struct timer *);
+
 /* Busy waits. */
 void timer_mdelay (int64_t milliseconds);
 void timer_udelay (int64_t microseconds);
 void timer_ndelay (int64_t nanoseconds);
 
+/* Tickless idle. */
+extern bool timer_tickless;
+void timer_idle_enter (void);
+void timer_idle_exit (void);
+int64_t timer_elided_ticks (void);
+
 void timer_print_stats (void);
 
 #endif /* devices/timer.h */
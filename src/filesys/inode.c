@@ -6,6 +6,7 @@
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
 #include "threads/malloc.h"
+#include "threads/synch.h"
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
@@ -28,7 +29,19 @@ bytes_to_sectors (off_t size)
   return DIV_ROUND_UP (size, BLOCK_SECTOR_SIZE);
 }
 
-/* In-memory inode. */
+/* In-memory inode.
+
+   There is no file system wide lock.  open_inodes_lock protects
+   the list of open inodes and each inode's open_cnt and removed
+   members.  Each inode's rwlock protects its data and
+   deny_write_cnt: any number of threads may read an inode at
+   once, but a write excludes reads and other writes of the same
+   inode.  Reads and writes of different inodes do not contend at
+   all.  dir_lock is for the directory code, which holds it to
+   make a lookup and the change that depends on it atomic.
+
+   Locks are acquired in this order: an inode's dir_lock,
+   open_inodes_lock, the free map's lock, an inode's rwlock. */
 struct inode 
   {
     struct list_elem elem;              /* Element in inode list. */
@@ -36,6 +49,8 @@ struct inode
     int open_cnt;                       /* Number of openers. */
     bool removed;                       /* True if deleted, false otherwise. */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
+    struct rwlock rwlock;               /* Protects data, deny_write_cnt. */
+    struct lock dir_lock;               /* Serializes directory changes. */
     struct inode_disk data;             /* Inode content. */
   };
 
@@ -57,11 +72,15 @@ byte_to_sector (const struct inode *inode, off_t pos)
    returns the same `struct inode'. */
 static struct list open_inodes;
 
+/* Protects open_inodes and the inodes' open_cnt and removed. */
+static struct lock open_inodes_lock;
+
 /* Initializes the inode module. */
 void
 inode_init (void) 
 {
   list_init (&open_inodes);
+  lock_init (&open_inodes_lock);
 }
 
 /* Initializes an inode with LENGTH bytes of data and
@@ -114,6 +133,8 @@ inode_open (block_sector_t sector)
   struct list_elem *e;
   struct inode *inode;
 
+  lock_acquire (&open_inodes_lock);
+
   /* Check whether this inode is already open. */
   for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
        e = list_next (e)) 
@@ -121,7 +142,8 @@ inode_open (block_sector_t sector)
       inode = list_entry (e, struct inode, elem);
       if (inode->sector == sector) 
         {
-          inode_reopen (inode);
+          inode->open_cnt++;
+          lock_release (&open_inodes_lock);
           return inode; 
         }
     }
@@ -129,15 +151,22 @@ inode_open (block_sector_t sector)
   /* Allocate memory. */
   inode = malloc (sizeof *inode);
   if (inode == NULL)
-    return NULL;
+    {
+      lock_release (&open_inodes_lock);
+      return NULL;
+    }
 
-  /* Initialize. */
+  /* Initialize.  The inode is read before the lock is released,
+     so that no one else can find it half initialized. */
   list_push_front (&open_inodes, &inode->elem);
   inode->sector = sector;
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
   inode->removed = false;
+  rwlock_init (&inode->rwlock);
+  lock_init (&inode->dir_lock);
   block_read (fs_device, inode->sector, &inode->data);
+  lock_release (&open_inodes_lock);
   return inode;
 }
 
@@ -146,7 +175,11 @@ struct inode *
 inode_reopen (struct inode *inode)
 {
   if (inode != NULL)
-    inode->open_cnt++;
+    {
+      lock_acquire (&open_inodes_lock);
+      inode->open_cnt++;
+      lock_release (&open_inodes_lock);
+    }
   return inode;
 }
 
@@ -163,16 +196,22 @@ inode_get_inumber (const struct inode *inode)
 void
 inode_close (struct inode *inode) 
 {
+  bool last;
+
   /* Ignore null pointer. */
   if (inode == NULL)
     return;
 
-  /* Release resources if this was the last opener. */
-  if (--inode->open_cnt == 0)
+  lock_acquire (&open_inodes_lock);
+  last = --inode->open_cnt == 0;
+  if (last)
+    list_remove (&inode->elem);
+  lock_release (&open_inodes_lock);
+
+  /* Release resources if this was the last opener.  No one else
+     can find INODE any more, so no lock is needed. */
+  if (last)
     {
-      /* Remove from inode list and release lock. */
-      list_remove (&inode->elem);
- 
       /* Deallocate blocks if removed. */
       if (inode->removed) 
         {
@@ -191,7 +230,9 @@ void
 inode_remove (struct inode *inode) 
 {
   ASSERT (inode != NULL);
+  lock_acquire (&open_inodes_lock);
   inode->removed = true;
+  lock_release (&open_inodes_lock);
 }
 
 /* Reads SIZE bytes from INODE into BUFFER, starting at position OFFSET.
@@ -204,6 +245,7 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
   off_t bytes_read = 0;
   uint8_t *bounce = NULL;
 
+  rwlock_acquire_read (&inode->rwlock);
   while (size > 0) 
     {
       /* Disk sector to read, starting byte offset within sector. */
@@ -244,6 +286,7 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset)
       offset += chunk_size;
       bytes_read += chunk_size;
     }
+  rwlock_release_read (&inode->rwlock);
   free (bounce);
 
   return bytes_read;
@@ -262,8 +305,9 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
   off_t bytes_written = 0;
   uint8_t *bounce = NULL;
 
+  rwlock_acquire_write (&inode->rwlock);
   if (inode->deny_write_cnt)
-    return 0;
+    size = 0;
 
   while (size > 0) 
     {
@@ -312,6 +356,7 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
       offset += chunk_size;
       bytes_written += chunk_size;
     }
+  rwlock_release_write (&inode->rwlock);
   free (bounce);
 
   return bytes_written;
@@ -322,8 +367,10 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 void
 inode_deny_write (struct inode *inode) 
 {
+  rwlock_acquire_write (&inode->rwlock);
   inode->deny_write_cnt++;
   ASSERT (inode->deny_write_cnt <= inode->open_cnt);
+  rwlock_release_write (&inode->rwlock);
 }
 
 /* Re-enables writes to INODE.
@@ -332,9 +379,28 @@ inode_deny_write (struct inode *inode)
 void
 inode_allow_write (struct inode *inode) 
 {
+  rwlock_acquire_write (&inode->rwlock);
   ASSERT (inode->deny_write_cnt > 0);
   ASSERT (inode->deny_write_cnt <= inode->open_cnt);
   inode->deny_write_cnt--;
+  rwlock_release_write (&inode->rwlock);
+}
+
+/* Acquires INODE's directory lock.  The directory code holds it
+   while it looks up an entry and acts on the result, so that no
+   other change to the directory can come in between.  It does
+   not exclude reads or writes of INODE's data. */
+void
+inode_lock_dir (struct inode *inode) 
+{
+  lock_acquire (&inode->dir_lock);
+}
+
+/* Releases INODE's directory lock. */
+void
+inode_unlock_dir (struct inode *inode) 
+{
+  lock_release (&inode->dir_lock);
 }
 
 /* Returns the length, in bytes, of INODE's data. */
@@ -0,0 +1,14 @@
+#ifndef __LIB_FUTEX_H
+#define __LIB_FUTEX_H
+
+/* Results of futex_wait(). */
+#define FUTEX_WOKEN 0           /* Woken by futex_wake(). */
+#define FUTEX_CHANGED 1         /* The word did not hold the value. */
+#define FUTEX_TIMEOUT 2         /* The timeout expired first. */
+
+/* futex_wait() timeout that never expires.  Not accepted yet:
+   nothing can wake a futex waiter until processes can share
+   memory, so futex_wait() returns -1 for it. */
+#define FUTEX_FOREVER (-1)
+
+#endif /* lib/futex.h */
@@ -0,0 +1,21 @@
+#ifndef __LIB_RUSAGE_H
+#define __LIB_RUSAGE_H
+
+#include <stdint.h>
+
+/* Resource usage of a process, as reported by getrusage(). */
+struct rusage
+  {
+    int64_t user_ticks;         /* Timer ticks spent in user mode. */
+    int64_t kernel_ticks;       /* Timer ticks spent in the kernel. */
+    int64_t voluntary_switches; /* Gave up the CPU by blocking or yielding. */
+    int64_t involuntary_switches; /* Preempted. */
+    int64_t page_faults;        /* Page faults taken. */
+    int64_t syscalls;           /* System calls made. */
+  };
+
+/* Values for getrusage()'s WHO argument. */
+#define RUSAGE_SELF 0           /* The calling process itself. */
+#define RUSAGE_CHILDREN (-1)    /* All of its waited-for descendants. */
+
+#endif /* lib/rusage.h */
@@ -28,7 +28,19 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_GETRUSAGE,              /* Obtain resource usage statistics. */
+    SYS_FUTEX_WAIT,             /* Wait on a futex. */
+    SYS_FUTEX_WAKE,             /* Wake threads waiting on a futex. */
+    SYS_SETTICKETS,             /* Set the stride scheduler's tickets. */
+    SYS_WAIT_TIMEOUT,           /* Wait for a child, with a timeout. */
+    SYS_SETQUANTUM,             /* Set the time slice. */
+    SYS_PREAD,                  /* Read from a file at a given position. */
+    SYS_PWRITE,                 /* Write to a file at a given position. */
+    SYS_READV,                  /* Read from a file into several buffers. */
+    SYS_WRITEV                  /* Write to a file from several buffers. */
   };
 
 #endif /* lib/syscall-nr.h */
@@ -0,0 +1,16 @@
+#ifndef __LIB_UIO_H
+#define __LIB_UIO_H
+
+#include <stddef.h>
+
+/* One buffer of a readv() or writev() call. */
+struct iovec
+  {
+    void *iov_base;             /* Start of the buffer. */
+    size_t iov_len;             /* Length of the buffer in bytes. */
+  };
+
+/* Most buffers that one readv() or writev() call may take. */
+#define IOV_MAX 16
+
+#endif /* lib/uio.h */
@@ -3,6 +3,10 @@
 
 #include <stdbool.h>
 #include <debug.h>
+#include <futex.h>
+#include <rusage.h>
+#include <uio.h>
+#include <wait.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -45,4 +49,16 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Extensions. */
+int getrusage (int who, struct rusage *);
+int futex_wait (int *addr, int val, int timeout_ms);
+int futex_wake (int *addr, int cnt);
+int settickets (int tickets);
+int wait_timeout (pid_t, int timeout_ms, int *status);
+int setquantum (int ticks);
+int pread (int fd, void *buffer, unsigned length, int offset);
+int pwrite (int fd, const void *buffer, unsigned length, int offset);
+int readv (int fd, const struct iovec *, int iovcnt);
+int writev (int fd, const struct iovec *, int iovcnt);
+
 #endif /* lib/user/syscall.h */
@@ -0,0 +1,11 @@
+#ifndef __LIB_WAIT_H
+#define __LIB_WAIT_H
+
+/* Results of wait_timeout(). */
+#define WAIT_EXITED 0           /* The child exited. */
+#define WAIT_TIMEOUT 1          /* The timeout expired first. */
+
+/* wait_timeout() timeout that never expires. */
+#define WAIT_FOREVER (-1)
+
+#endif /* lib/wait.h */
@@ -0,0 +1,103 @@
+/* Measures how much CPU time is left for a compute-bound thread
+   while many other threads are sleeping in timer_sleep().
+
+   The main thread first counts how many loop iterations it can
+   run in a fixed number of ticks with nothing else going on.
+   It then starts SLEEPER_CNT threads that repeatedly sleep for
+   a few ticks each, counts again, and reports the second count
+   as a percentage of the first.  Sleeping threads should be
+   blocked rather than spinning on the run queue, so the compute
+   thread should keep nearly all of the CPU. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define SLEEPER_CNT 100         /* Number of sleeping threads. */
+#define WINDOW_TICKS 200        /* Length of each measurement. */
+#define MIN_PERCENT 50          /* Lowest acceptable CPU share. */
+
+/* Information shared with the sleeper threads. */
+struct sleepers 
+  {
+    volatile bool stop;         /* Set to ask sleepers to exit. */
+    struct semaphore done;      /* Upped by each sleeper as it exits. */
+  };
+
+static thread_func sleeper;
+static unsigned long long count_iterations (int64_t window);
+
+void
+test_alarm_sleepers (void) 
+{
+  struct sleepers s;
+  unsigned long long idle_cnt, loaded_cnt;
+  int percent;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  msg ("Measuring compute throughput with no sleepers.");
+  idle_cnt = count_iterations (WINDOW_TICKS);
+
+  msg ("Starting %d sleeper threads.", SLEEPER_CNT);
+  s.stop = false;
+  sema_init (&s.done, 0);
+  for (i = 0; i < SLEEPER_CNT; i++) 
+    {
+      char name[16];
+      snprintf (name, sizeof name, "sleeper %d", i);
+      thread_create (name, PRI_DEFAULT, sleeper, &s);
+    }
+
+  msg ("Measuring compute throughput with %d sleepers.", SLEEPER_CNT);
+  loaded_cnt = count_iterations (WINDOW_TICKS);
+
+  s.stop = true;
+  for (i = 0; i < SLEEPER_CNT; i++)
+    sema_down (&s.done);
+
+  percent = idle_cnt > 0 ? loaded_cnt * 100 / idle_cnt : 0;
+  msg ("%llu iterations alone, %llu with sleepers: %d%% of CPU left.",
+       idle_cnt, loaded_cnt, percent);
+  if (percent < MIN_PERCENT)
+    fail ("compute thread got only %d%% of the CPU (expected at least %d%%)",
+          percent, MIN_PERCENT);
+  pass ();
+}
+
+/* Sleeper thread.  Sleeps a few ticks at a time, staggered by
+   tid so that wake-ups are spread out, until asked to stop. */
+static void
+sleeper (void *s_) 
+{
+  struct sleepers *s = s_;
+  int64_t duration = 5 + thread_tid () % 10;
+
+  while (!s->stop)
+    timer_sleep (duration);
+  sema_up (&s->done);
+}
+
+/* Spins for WINDOW timer ticks, starting at a tick boundary,
+   and returns the number of loop iterations completed. */
+static unsigned long long
+count_iterations (int64_t window) 
+{
+  unsigned long long cnt = 0;
+  int64_t start = timer_ticks ();
+
+  while (timer_ticks () == start)
+    continue;
+  start = timer_ticks ();
+  while (timer_elapsed (start) < window) 
+    {
+      barrier ();
+      cnt++;
+    }
+  return cnt;
+}
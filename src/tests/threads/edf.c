@@ -0,0 +1,153 @@
+/* Checks the earliest-deadline-first real-time class.
+
+   Two periodic threads, one with a deadline shorter than its
+   period, run a fixed number of jobs each while a PRI_MAX thread
+   spins the whole time.  Because real-time threads run before
+   all others, neither should miss a deadline.  A third real-time
+   thread spins without ever ending its job, and so should be held
+   to its budget of 2 ticks in every 10.  Finally, a request that
+   would take the real-time load past what can be guaranteed must
+   be refused. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define JOB_CNT 10              /* Jobs per periodic thread. */
+#define HOG_TICKS 300           /* Ticks the PRI_MAX thread spins. */
+#define GREEDY_PERIODS 10       /* Periods the greedy thread spins. */
+
+struct rt_info
+  {
+    const char *name;
+    int64_t period, runtime, deadline;
+    bool admitted;
+    long long misses;
+    int64_t ticks;
+    struct semaphore *ready, *done;
+  };
+
+static thread_func periodic_thread, greedy_thread, hog_thread;
+static void spin_ticks (int64_t cnt);
+
+void
+test_edf (void) 
+{
+  struct rt_info info[3] = {
+    {"periodic A", 20, 4, 20, false, 0, 0, NULL, NULL},
+    {"periodic B", 10, 3, 8, false, 0, 0, NULL, NULL},
+    {"greedy", 10, 2, 10, false, 0, 0, NULL, NULL},
+  };
+  struct semaphore ready, done;
+  int64_t hog_end;
+  int i;
+
+  sema_init (&ready, 0);
+  sema_init (&done, 0);
+  for (i = 0; i < 3; i++)
+    {
+      info[i].ready = &ready;
+      info[i].done = &done;
+      thread_create (info[i].name, PRI_DEFAULT,
+                     i < 2 ? periodic_thread : greedy_thread, &info[i]);
+    }
+  for (i = 0; i < 3; i++)
+    sema_down (&ready);
+  for (i = 0; i < 3; i++)
+    msg ("Thread \"%s\" %s.", info[i].name,
+         info[i].admitted ? "admitted" : "refused");
+
+  /* 20% + 37.5% + 20% are admitted, but 30% more is too much. */
+  if (thread_rt_set (10, 3, 10))
+    fail ("Overloading real-time request was admitted.");
+  msg ("Overloading request refused.");
+
+  hog_end = timer_ticks () + HOG_TICKS;
+  thread_create ("hog", PRI_MAX, hog_thread, &hog_end);
+
+  for (i = 0; i < 3; i++)
+    sema_down (&done);
+  for (i = 0; i < 2; i++)
+    {
+      if (info[i].misses != 0)
+        fail ("Thread \"%s\" missed %lld deadlines.",
+              info[i].name, info[i].misses);
+      msg ("Thread \"%s\" met all its deadlines.", info[i].name);
+    }
+  if (info[2].ticks > (GREEDY_PERIODS + 1) * info[2].runtime)
+    fail ("Thread \"greedy\" ran %lld ticks in %d periods.",
+          (long long) info[2].ticks, GREEDY_PERIODS);
+  msg ("Thread \"greedy\" was held to its budget.");
+  pass ();
+}
+
+/* Runs JOB_CNT jobs, each of which spins for less than the
+   thread's runtime. */
+static void
+periodic_thread (void *info_) 
+{
+  struct rt_info *info = info_;
+  int i;
+
+  info->admitted = thread_rt_set (info->period, info->runtime,
+                                  info->deadline);
+  sema_up (info->ready);
+  for (i = 0; i < JOB_CNT; i++)
+    {
+      spin_ticks (info->runtime - 2);
+      thread_rt_wait ();
+    }
+  info->misses = thread_rt_get_misses ();
+  thread_rt_clear ();
+  sema_up (info->done);
+}
+
+/* Spins through GREEDY_PERIODS periods without ever ending its
+   job, counting the ticks it is charged for. */
+static void
+greedy_thread (void *info_) 
+{
+  struct rt_info *info = info_;
+  int64_t start, end;
+  int64_t ticks;
+
+  info->admitted = thread_rt_set (info->period, info->runtime,
+                                  info->deadline);
+  sema_up (info->ready);
+  start = timer_ticks ();
+  end = start + GREEDY_PERIODS * info->period;
+  ticks = thread_current ()->usage.kernel_ticks;
+  while (timer_ticks () < end)
+    continue;
+  info->ticks = thread_current ()->usage.kernel_ticks - ticks;
+  thread_rt_clear ();
+  sema_up (info->done);
+}
+
+/* Spins until the tick pointed to by END_. */
+static void
+hog_thread (void *end_) 
+{
+  const int64_t *end = end_;
+
+  while (timer_ticks () < *end)
+    continue;
+}
+
+/* Spins until the timer has ticked CNT times. */
+static void
+spin_ticks (int64_t cnt) 
+{
+  int64_t last = timer_ticks ();
+
+  while (cnt > 0)
+    {
+      int64_t now = timer_ticks ();
+      if (now != last)
+        cnt--;
+      last = now;
+    }
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(edf) begin
+(edf) Thread "periodic A" admitted.
+(edf) Thread "periodic B" admitted.
+(edf) Thread "greedy" admitted.
+(edf) Overloading request refused.
+(edf) Thread "periodic A" met all its deadlines.
+(edf) Thread "periodic B" met all its deadlines.
+(edf) Thread "greedy" was held to its budget.
+(edf) PASS
+(edf) end
+EOF
+pass;
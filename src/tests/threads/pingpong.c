@@ -0,0 +1,114 @@
+/* Measures how many round trips a pair of threads can make by
+   upping each other's semaphores, first with thread_handoff off
+   and then with it on.
+
+   A third thread of the same priority spins throughout.  Without
+   handoff, each thread woken by the other waits behind the
+   spinner for a whole time slice; with it, the woken thread runs
+   at once on the rest of its waker's slice. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define WINDOW_TICKS 100        /* Length of each measurement. */
+
+struct pingpong
+  {
+    struct semaphore ping;      /* Upped to wake the ponger. */
+    struct semaphore pong;      /* Upped to wake the pinger. */
+    struct semaphore done;      /* Upped by each exiting thread. */
+    bool stop;                  /* Set to make the others exit. */
+  };
+
+static thread_func ponger;
+static thread_func spinner;
+static long long count_round_trips (int64_t window);
+
+void
+test_pingpong (void) 
+{
+  bool saved = thread_handoff;
+  long long queued_cnt, handoff_cnt;
+
+  msg ("Ping-ponging with handoff disabled.");
+  thread_handoff = false;
+  queued_cnt = count_round_trips (WINDOW_TICKS);
+
+  msg ("Ping-ponging with handoff enabled.");
+  thread_handoff = true;
+  handoff_cnt = count_round_trips (WINDOW_TICKS);
+  thread_handoff = saved;
+
+  msg ("%lld round trips/s without handoff, %lld round trips/s with it.",
+       queued_cnt * TIMER_FREQ / WINDOW_TICKS,
+       handoff_cnt * TIMER_FREQ / WINDOW_TICKS);
+  pass ();
+}
+
+/* Thread function that answers each up of PP_'s ping semaphore
+   by upping its pong semaphore, until PP_'s stop flag is set. */
+static void
+ponger (void *pp_) 
+{
+  struct pingpong *pp = pp_;
+
+  for (;;)
+    {
+      sema_down (&pp->ping);
+      if (pp->stop)
+        break;
+      sema_up (&pp->pong);
+    }
+  sema_up (&pp->done);
+}
+
+/* Thread function that spins until PP_'s stop flag is set. */
+static void
+spinner (void *pp_) 
+{
+  struct pingpong *pp = pp_;
+
+  while (!pp->stop)
+    barrier ();
+  sema_up (&pp->done);
+}
+
+/* Ping-pongs with a ponger thread for WINDOW timer ticks,
+   starting at a tick boundary, while a spinner thread competes
+   for the CPU, and returns the number of round trips made. */
+static long long
+count_round_trips (int64_t window) 
+{
+  struct pingpong pp;
+  long long cnt = 0;
+  int64_t start;
+
+  sema_init (&pp.ping, 0);
+  sema_init (&pp.pong, 0);
+  sema_init (&pp.done, 0);
+  pp.stop = false;
+  if (thread_create ("ponger", PRI_DEFAULT, ponger, &pp) == TID_ERROR
+      || thread_create ("spinner", PRI_DEFAULT, spinner, &pp) == TID_ERROR)
+    fail ("thread_create failed");
+
+  start = timer_ticks ();
+  while (timer_ticks () == start)
+    continue;
+  start = timer_ticks ();
+  while (timer_elapsed (start) < window) 
+    {
+      sema_up (&pp.ping);
+      sema_down (&pp.pong);
+      cnt++;
+    }
+
+  pp.stop = true;
+  sema_up (&pp.ping);
+  sema_down (&pp.done);
+  sema_down (&pp.done);
+  return cnt;
+}
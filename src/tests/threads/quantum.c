@@ -0,0 +1,109 @@
+/* Checks that a thread's own quantum sets the length of its time
+   slice.
+
+   Two threads of equal priority spin for 10 seconds, counting
+   the timer ticks during which they ran.  One has a quantum of
+   2 ticks and the other a quantum of 6, so round-robin
+   scheduling should give them about 1/4 and 3/4 of the ticks,
+   respectively.  Each share must be within SHARE_SLACK percent
+   of the total of its ideal value. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define THREAD_CNT 2
+#define SHARE_SLACK 3           /* Allowed error, in percent. */
+
+struct thread_info
+  {
+    int64_t start_time;
+    int quantum;
+    int tick_count;
+    struct semaphore *done;
+  };
+
+static thread_func load_thread;
+
+void
+test_quantum (void) 
+{
+  struct thread_info info[THREAD_CNT];
+  struct semaphore done;
+  int64_t start_time;
+  int total_quantum = 0, total_ticks = 0;
+  int i;
+
+  ASSERT (!thread_mlfqs);
+
+  if (thread_get_quantum () != thread_time_slice)
+    fail ("Default quantum is %d, expected %d.",
+          thread_get_quantum (), thread_time_slice);
+  thread_set_quantum (7);
+  if (thread_get_quantum () != 7)
+    fail ("Quantum is %d after setting it to 7.", thread_get_quantum ());
+  thread_set_quantum (0);
+  if (thread_get_quantum () != thread_time_slice)
+    fail ("Quantum is %d after resetting it, expected %d.",
+          thread_get_quantum (), thread_time_slice);
+
+  sema_init (&done, 0);
+  start_time = timer_ticks ();
+  msg ("Starting %d threads...", THREAD_CNT);
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      struct thread_info *ti = &info[i];
+      char name[16];
+
+      ti->start_time = start_time;
+      ti->quantum = 2 + 4 * i;
+      ti->tick_count = 0;
+      ti->done = &done;
+      total_quantum += ti->quantum;
+
+      snprintf (name, sizeof name, "load %d", i);
+      thread_create (name, PRI_DEFAULT, load_thread, ti);
+    }
+
+  msg ("Sleeping 12 seconds to let threads run, please wait...");
+  for (i = 0; i < THREAD_CNT; i++)
+    sema_down (&done);
+
+  for (i = 0; i < THREAD_CNT; i++)
+    total_ticks += info[i].tick_count;
+  for (i = 0; i < THREAD_CNT; i++) 
+    {
+      int share = info[i].tick_count * 100 / total_ticks;
+      int ideal = info[i].quantum * 100 / total_quantum;
+
+      if (share < ideal - SHARE_SLACK || share > ideal + SHARE_SLACK)
+        fail ("Thread %d with a %d-tick quantum received %d%% of the CPU, "
+              "expected %d%%.", i, info[i].quantum, share, ideal);
+      msg ("Thread %d with a %d-tick quantum received its share.",
+           i, info[i].quantum);
+    }
+  pass ();
+}
+
+static void
+load_thread (void *ti_) 
+{
+  struct thread_info *ti = ti_;
+  int64_t sleep_time = 2 * TIMER_FREQ;
+  int64_t spin_time = sleep_time + 10 * TIMER_FREQ;
+  int64_t last_time = 0;
+
+  thread_set_quantum (ti->quantum);
+  timer_sleep (sleep_time - timer_elapsed (ti->start_time));
+  while (timer_elapsed (ti->start_time) < spin_time) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        ti->tick_count++;
+      last_time = cur_time;
+    }
+  sema_up (ti->done);
+}
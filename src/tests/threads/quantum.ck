@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(quantum) begin
+(quantum) Starting 2 threads...
+(quantum) Sleeping 12 seconds to let threads run, please wait...
+(quantum) Thread 0 with a 2-tick quantum received its share.
+(quantum) Thread 1 with a 6-tick quantum received its share.
+(quantum) PASS
+(quantum) end
+EOF
+pass;
@@ -0,0 +1,105 @@
+/* Checks that readers share a readers-writer lock, that a
+   waiting writer keeps new readers out, and that a writer lets
+   the readers that waited behind it in before any other writer.
+
+   The main thread holds the lock for reading.  A reader at
+   priority PRI_DEFAULT + 1 gets it as well, then blocks on a
+   semaphore.  A writer at PRI_DEFAULT + 2 has to wait, and so
+   does a second reader at PRI_DEFAULT + 3, because a writer is
+   waiting.  When both readers are gone, the writer gets the
+   lock, and releasing it lets the second reader in.  Finally the
+   main thread upgrades and downgrades the lock on its own. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+struct rwlock_test 
+  {
+    struct rwlock rw;
+    struct semaphore go;        /* Lets the first reader release. */
+    struct semaphore done;      /* Upped by each thread as it exits. */
+  };
+
+static thread_func reader_1_func;
+static thread_func writer_func;
+static thread_func reader_2_func;
+
+void
+test_rwlock (void) 
+{
+  struct rwlock_test t;
+  int i;
+
+  /* This test does not work with the MLFQS. */
+  ASSERT (!thread_mlfqs);
+
+  /* Make sure our priority is the default. */
+  ASSERT (thread_get_priority () == PRI_DEFAULT);
+
+  rwlock_init (&t.rw);
+  sema_init (&t.go, 0);
+  sema_init (&t.done, 0);
+
+  rwlock_acquire_read (&t.rw);
+  thread_create ("reader 1", PRI_DEFAULT + 1, reader_1_func, &t);
+  thread_create ("writer", PRI_DEFAULT + 2, writer_func, &t);
+  thread_create ("reader 2", PRI_DEFAULT + 3, reader_2_func, &t);
+
+  if (rwlock_try_acquire_read (&t.rw))
+    fail ("try_acquire_read succeeded with a writer waiting");
+  msg ("try_acquire_read failed with a writer waiting.");
+
+  rwlock_release_read (&t.rw);
+  sema_up (&t.go);
+  for (i = 0; i < 3; i++)
+    sema_down (&t.done);
+
+  rwlock_acquire_read (&t.rw);
+  if (!rwlock_try_upgrade (&t.rw) || !rwlock_held_for_write (&t.rw))
+    fail ("sole reader could not upgrade");
+  rwlock_downgrade (&t.rw);
+  if (rwlock_held_for_write (&t.rw) || rwlock_try_acquire_write (&t.rw))
+    fail ("downgraded lock still held for writing");
+  rwlock_release_read (&t.rw);
+  if (!rwlock_try_acquire_write (&t.rw))
+    fail ("free lock could not be acquired for writing");
+  rwlock_release_write (&t.rw);
+  msg ("Upgrade and downgrade work.");
+}
+
+static void
+reader_1_func (void *t_) 
+{
+  struct rwlock_test *t = t_;
+
+  rwlock_acquire_read (&t->rw);
+  msg ("Reader 1 acquired the lock while main holds it.");
+  sema_down (&t->go);
+  rwlock_release_read (&t->rw);
+  sema_up (&t->done);
+}
+
+static void
+writer_func (void *t_) 
+{
+  struct rwlock_test *t = t_;
+
+  rwlock_acquire_write (&t->rw);
+  msg ("Writer acquired the lock.");
+  rwlock_release_write (&t->rw);
+  sema_up (&t->done);
+}
+
+static void
+reader_2_func (void *t_) 
+{
+  struct rwlock_test *t = t_;
+
+  rwlock_acquire_read (&t->rw);
+  msg ("Reader 2 acquired the lock.");
+  rwlock_release_read (&t->rw);
+  sema_up (&t->done);
+}
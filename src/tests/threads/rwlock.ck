@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(rwlock) begin
+(rwlock) Reader 1 acquired the lock while main holds it.
+(rwlock) try_acquire_read failed with a writer waiting.
+(rwlock) Writer acquired the lock.
+(rwlock) Reader 2 acquired the lock.
+(rwlock) Upgrade and downgrade work.
+(rwlock) end
+EOF
+pass;
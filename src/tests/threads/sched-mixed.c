@@ -0,0 +1,118 @@
+/* Runs CPU-bound and I/O-bound threads side by side and reports
+   how the scheduler treats each kind.
+
+   CPU_CNT threads spin for 5 seconds.  Meanwhile IO_CNT threads
+   repeatedly sleep for IO_SLEEP ticks, as if waiting for a
+   device, and note how many ticks late they got the CPU back.
+   Under round-robin a woken thread waits behind every spinner's
+   time slice; a scheduler that credits sleepers should run it
+   almost at once, at little cost to the spinners' throughput.
+
+   Run as sched-mixed with the default scheduler and as
+   sched-mixed-cfs with -sched=cfs, so the two can be compared. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define CPU_CNT 3               /* Number of CPU-bound threads. */
+#define IO_CNT 2                /* Number of I/O-bound threads. */
+#define IO_SLEEP 2              /* Ticks per simulated I/O. */
+
+struct mixed
+  {
+    int64_t start_time;         /* When the threads were created. */
+    int64_t run_time;           /* How long they run. */
+    struct semaphore done;      /* Upped by each finished thread. */
+    long long cpu_ticks;        /* Ticks counted by spinners. */
+    long long io_cnt;           /* Wakeups of I/O-bound threads. */
+    long long io_latency;       /* Total ticks late of those. */
+    int64_t io_latency_max;     /* Most ticks late of those. */
+  };
+
+static thread_func cpu_thread;
+static thread_func io_thread;
+
+void
+test_sched_mixed (void) 
+{
+  struct mixed m;
+  int i;
+
+  ASSERT (!thread_mlfqs);
+
+  sema_init (&m.done, 0);
+  m.start_time = timer_ticks ();
+  m.run_time = 5 * TIMER_FREQ;
+  m.cpu_ticks = m.io_cnt = m.io_latency = m.io_latency_max = 0;
+
+  msg ("Starting %d CPU-bound and %d I/O-bound threads...", CPU_CNT, IO_CNT);
+  for (i = 0; i < CPU_CNT; i++)
+    thread_create ("cpu", PRI_DEFAULT, cpu_thread, &m);
+  for (i = 0; i < IO_CNT; i++)
+    thread_create ("io", PRI_DEFAULT, io_thread, &m);
+  for (i = 0; i < CPU_CNT + IO_CNT; i++)
+    sema_down (&m.done);
+
+  msg ("CPU-bound threads ran for %lld of %lld ticks.",
+       m.cpu_ticks, (long long) m.run_time);
+  msg ("I/O-bound threads woke %lld times, %lld.%02lld ticks late "
+       "on average, %lld at most.",
+       m.io_cnt, m.io_latency / m.io_cnt,
+       m.io_latency * 100 / m.io_cnt % 100, (long long) m.io_latency_max);
+  pass ();
+}
+
+/* Spins until M_'s run time is up, counting the ticks during
+   which it ran. */
+static void
+cpu_thread (void *m_) 
+{
+  struct mixed *m = m_;
+  int64_t last_time = 0;
+  long long tick_cnt = 0;
+  enum intr_level old_level;
+
+  while (timer_elapsed (m->start_time) < m->run_time) 
+    {
+      int64_t cur_time = timer_ticks ();
+      if (cur_time != last_time)
+        tick_cnt++;
+      last_time = cur_time;
+    }
+
+  old_level = intr_disable ();
+  m->cpu_ticks += tick_cnt;
+  intr_set_level (old_level);
+  sema_up (&m->done);
+}
+
+/* Sleeps IO_SLEEP ticks at a time until M_'s run time is up,
+   recording how late it runs again after each sleep. */
+static void
+io_thread (void *m_) 
+{
+  struct mixed *m = m_;
+
+  while (timer_elapsed (m->start_time) < m->run_time) 
+    {
+      int64_t due = timer_ticks () + IO_SLEEP;
+      int64_t late;
+      enum intr_level old_level;
+
+      timer_sleep (IO_SLEEP);
+      late = timer_ticks () - due;
+
+      old_level = intr_disable ();
+      m->io_cnt++;
+      m->io_latency += late;
+      if (late > m->io_latency_max)
+        m->io_latency_max = late;
+      intr_set_level (old_level);
+    }
+  sema_up (&m->done);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(stride-fair) begin
+(stride-fair) Starting 3 threads...
+(stride-fair) Sleeping 12 seconds to let threads run, please wait...
+(stride-fair) Thread 0 with 100 tickets received its share.
+(stride-fair) Thread 1 with 200 tickets received its share.
+(stride-fair) Thread 2 with 300 tickets received its share.
+(stride-fair) PASS
+(stride-fair) end
+EOF
+pass;
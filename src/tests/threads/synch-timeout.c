@@ -0,0 +1,153 @@
+/* Checks sema_down_timeout(), lock_acquire_timeout(), and
+   cond_wait_timeout(): each must give up after its timeout when
+   nothing happens and succeed when it is woken in time.  A lock
+   wait that times out must also withdraw its priority donation
+   from the lock's holder and, if that holder is waiting for
+   another lock, from the holders further along the chain. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define HOLDER_PRI (PRI_DEFAULT - 10)
+#define OUTER_PRI (PRI_DEFAULT - 20)
+
+static struct semaphore sema;
+static struct lock lock, outer_lock;
+static struct condition cond;
+static struct thread *holder, *outer;
+
+static thread_func upper, holder_thread, chained_holder_thread,
+  outer_thread, signaler;
+
+void
+test_synch_timeout (void) 
+{
+  struct semaphore ready;
+  int64_t start;
+
+  ASSERT (!thread_mlfqs);
+
+  /* Semaphores. */
+  sema_init (&sema, 0);
+  start = timer_ticks ();
+  if (sema_down_timeout (&sema, 10))
+    fail ("sema_down_timeout succeeded on a 0 semaphore.");
+  if (timer_elapsed (start) < 10)
+    fail ("sema_down_timeout returned after %lld of 10 ticks.",
+          (long long) timer_elapsed (start));
+  msg ("sema_down_timeout timed out.");
+
+  thread_create ("upper", PRI_DEFAULT, upper, NULL);
+  if (!sema_down_timeout (&sema, 100))
+    fail ("sema_down_timeout timed out despite sema_up.");
+  msg ("sema_down_timeout succeeded.");
+
+  /* Locks. */
+  lock_init (&lock);
+  sema_init (&ready, 0);
+  thread_create ("holder", HOLDER_PRI, holder_thread, &ready);
+  sema_down (&ready);
+  if (lock_acquire_timeout (&lock, 10))
+    fail ("lock_acquire_timeout acquired a held lock.");
+  if (holder->priority != HOLDER_PRI)
+    fail ("holder kept priority %d after the wait timed out.",
+          holder->priority);
+  msg ("lock_acquire_timeout timed out and withdrew its donation.");
+  if (!lock_acquire_timeout (&lock, 100))
+    fail ("lock_acquire_timeout timed out despite lock_release.");
+  msg ("lock_acquire_timeout succeeded.");
+  lock_release (&lock);
+
+  /* A chain of lock holders: "holder" holds LOCK and waits for
+     OUTER_LOCK, which "outer" holds. */
+  lock_init (&outer_lock);
+  thread_create ("outer", OUTER_PRI, outer_thread, &ready);
+  sema_down (&ready);
+  thread_create ("holder", HOLDER_PRI, chained_holder_thread, &ready);
+  sema_down (&ready);
+  if (lock_acquire_timeout (&lock, 10))
+    fail ("lock_acquire_timeout acquired a held lock.");
+  if (outer->priority != HOLDER_PRI)
+    fail ("outer has priority %d after the wait timed out, not %d.",
+          outer->priority, HOLDER_PRI);
+  msg ("lock_acquire_timeout withdrew its donation along the chain.");
+  lock_acquire (&lock);
+
+  /* Condition variables. */
+  cond_init (&cond);
+  if (cond_wait_timeout (&cond, &lock, 10))
+    fail ("cond_wait_timeout returned signaled without a signal.");
+  if (!lock_held_by_current_thread (&lock))
+    fail ("cond_wait_timeout did not reacquire the lock.");
+  msg ("cond_wait_timeout timed out.");
+
+  thread_create ("signaler", PRI_DEFAULT, signaler, NULL);
+  if (!cond_wait_timeout (&cond, &lock, 100))
+    fail ("cond_wait_timeout timed out despite cond_signal.");
+  msg ("cond_wait_timeout succeeded.");
+  lock_release (&lock);
+
+  pass ();
+}
+
+/* Ups the semaphore after 5 ticks. */
+static void
+upper (void *aux UNUSED) 
+{
+  timer_sleep (5);
+  sema_up (&sema);
+}
+
+/* Holds the lock for 30 ticks. */
+static void
+holder_thread (void *ready_) 
+{
+  struct semaphore *ready = ready_;
+
+  holder = thread_current ();
+  lock_acquire (&lock);
+  sema_up (ready);
+  timer_sleep (30);
+  lock_release (&lock);
+}
+
+/* Holds OUTER_LOCK for 30 ticks. */
+static void
+outer_thread (void *ready_) 
+{
+  struct semaphore *ready = ready_;
+
+  outer = thread_current ();
+  lock_acquire (&outer_lock);
+  sema_up (ready);
+  timer_sleep (30);
+  lock_release (&outer_lock);
+}
+
+/* Acquires the lock, then waits for OUTER_LOCK while holding
+   it. */
+static void
+chained_holder_thread (void *ready_) 
+{
+  struct semaphore *ready = ready_;
+
+  lock_acquire (&lock);
+  sema_up (ready);
+  lock_acquire (&outer_lock);
+  lock_release (&outer_lock);
+  lock_release (&lock);
+}
+
+/* Signals the condition after 5 ticks. */
+static void
+signaler (void *aux UNUSED) 
+{
+  timer_sleep (5);
+  lock_acquire (&lock);
+  cond_signal (&cond, &lock);
+  lock_release (&lock);
+}
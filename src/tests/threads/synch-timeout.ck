@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(synch-timeout) begin
+(synch-timeout) sema_down_timeout timed out.
+(synch-timeout) sema_down_timeout succeeded.
+(synch-timeout) lock_acquire_timeout timed out and withdrew its donation.
+(synch-timeout) lock_acquire_timeout succeeded.
+(synch-timeout) lock_acquire_timeout withdrew its donation along the chain.
+(synch-timeout) cond_wait_timeout timed out.
+(synch-timeout) cond_wait_timeout succeeded.
+(synch-timeout) PASS
+(synch-timeout) end
+EOF
+pass;
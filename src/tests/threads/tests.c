@@ -17,6 +17,7 @@ static const struct test tests[] =
     {"alarm-priority", test_alarm_priority},
     {"alarm-zero", test_alarm_zero},
     {"alarm-negative", test_alarm_negative},
+    {"alarm-sleepers", test_alarm_sleepers},
     {"priority-change", test_priority_change},
     {"priority-donate-one", test_priority_donate_one},
     {"priority-donate-multiple", test_priority_donate_multiple},
@@ -38,6 +39,17 @@ static const struct test tests[] =
     {"mlfqs-nice-2", test_mlfqs_nice_2},
     {"mlfqs-nice-10", test_mlfqs_nice_10},
     {"mlfqs-block", test_mlfqs_block},
+    {"thread-create", test_thread_create},
+    {"workqueue", test_workqueue},
+    {"rwlock", test_rwlock},
+    {"stride-fair", test_stride_fair},
+    {"edf", test_edf},
+    {"synch-timeout", test_synch_timeout},
+    {"timer-wheel", test_timer_wheel},
+    {"quantum", test_quantum},
+    {"pingpong", test_pingpong},
+    {"sched-mixed", test_sched_mixed},
+    {"sched-mixed-cfs", test_sched_mixed},
   };
 
 static const char *test_name;
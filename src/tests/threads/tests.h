@@ -11,6 +11,7 @@ extern test_func test_alarm_simultaneous;
 extern test_func test_alarm_priority;
 extern test_func test_alarm_zero;
 extern test_func test_alarm_negative;
+extern test_func test_alarm_sleepers;
 extern test_func test_priority_change;
 extern test_func test_priority_donate_one;
 extern test_func test_priority_donate_multiple;
@@ -32,6 +33,16 @@ extern test_func test_mlfqs_fair_20;
 extern test_func test_mlfqs_nice_2;
 extern test_func test_mlfqs_nice_10;
 extern test_func test_mlfqs_block;
+extern test_func test_thread_create;
+extern test_func test_workqueue;
+extern test_func test_rwlock;
+extern test_func test_stride_fair;
+extern test_func test_edf;
+extern test_func test_synch_timeout;
+extern test_func test_timer_wheel;
+extern test_func test_quantum;
+extern test_func test_pingpong;
+extern test_func test_sched_mixed;
 
 void msg (const char *, ...);
 void fail (const char *, ...);
@@ -0,0 +1,74 @@
+/* Measures how many threads can be created and joined per
+   second, first with the thread page cache disabled, so that
+   every thread_create() allocates and every exit frees a page,
+   and then with it enabled.
+
+   Each thread does nothing but up a semaphore, which the main
+   thread downs before creating the next one, so the measurement
+   is dominated by the cost of creating and destroying threads. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+#define WINDOW_TICKS 100        /* Length of each measurement. */
+
+static thread_func joiner;
+static long long count_creates (int64_t window);
+
+void
+test_thread_create (void) 
+{
+  bool saved = thread_page_cache;
+  long long uncached_cnt, cached_cnt;
+
+  msg ("Creating threads with the page cache disabled.");
+  thread_page_cache = false;
+  uncached_cnt = count_creates (WINDOW_TICKS);
+
+  msg ("Creating threads with the page cache enabled.");
+  thread_page_cache = true;
+  cached_cnt = count_creates (WINDOW_TICKS);
+  thread_page_cache = saved;
+
+  msg ("%lld threads/s without the cache, %lld threads/s with it.",
+       uncached_cnt * TIMER_FREQ / WINDOW_TICKS,
+       cached_cnt * TIMER_FREQ / WINDOW_TICKS);
+  pass ();
+}
+
+/* Thread function that signals semaphore DONE_ and exits. */
+static void
+joiner (void *done_) 
+{
+  struct semaphore *done = done_;
+
+  sema_up (done);
+}
+
+/* Creates and joins threads one at a time for WINDOW timer
+   ticks, starting at a tick boundary, and returns the number of
+   threads created. */
+static long long
+count_creates (int64_t window) 
+{
+  struct semaphore done;
+  long long cnt = 0;
+  int64_t start = timer_ticks ();
+
+  sema_init (&done, 0);
+  while (timer_ticks () == start)
+    continue;
+  start = timer_ticks ();
+  while (timer_elapsed (start) < window) 
+    {
+      if (thread_create ("joiner", PRI_DEFAULT, joiner, &done) == TID_ERROR)
+        fail ("thread_create failed after %lld threads", cnt);
+      sema_down (&done);
+      cnt++;
+    }
+  return cnt;
+}
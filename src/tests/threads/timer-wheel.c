@@ -0,0 +1,109 @@
+/* Checks timer_add() and timer_cancel().
+
+   Adds timers due 1, 2, 100, 255, 256, 300, and 700 ticks from
+   now, which exercises the root level of the timer wheel and a
+   cascade from the level above it, plus one that is already
+   overdue, and cancels two of them.  Each callback records the
+   tick at which it ran, which must be exactly its expiry time
+   (or the next tick, for the overdue one), and the cancelled
+   timers must not run at all.  One callback re-adds its own
+   timer once. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/init.h"
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "devices/timer.h"
+
+struct wheel_test
+  {
+    struct timer timer;
+    int64_t expires;            /* Tick it should run at. */
+    int64_t ran;                /* Tick it ran at, or -1. */
+    bool cancel;                /* Cancel it before it runs? */
+    bool readd;                 /* Add it again, 50 ticks later? */
+  };
+
+static timer_func record;
+
+void
+test_timer_wheel (void) 
+{
+  static const int offsets[] = {1, 2, 100, 255, 256, 300, 700, -5};
+  enum { TEST_CNT = sizeof offsets / sizeof *offsets };
+  struct wheel_test tests[TEST_CNT];
+  enum intr_level old_level;
+  int64_t start;
+  int i;
+
+  /* Keep the clock still while adding, so that every expiry time
+     is measured from the same tick. */
+  old_level = intr_disable ();
+  start = timer_ticks ();
+  for (i = 0; i < TEST_CNT; i++) 
+    {
+      struct wheel_test *t = &tests[i];
+
+      t->expires = start + offsets[i];
+      t->ran = -1;
+      t->cancel = offsets[i] == 100 || offsets[i] == 700;
+      t->readd = offsets[i] == 2;
+      timer_setup (&t->timer);
+      timer_add (&t->timer, record, t, t->expires);
+    }
+  intr_set_level (old_level);
+
+  for (i = 0; i < TEST_CNT; i++)
+    if (tests[i].cancel && !timer_cancel (&tests[i].timer))
+      fail ("timer %d was not pending when cancelled", i);
+
+  msg ("Sleeping 8 seconds, please wait...");
+  timer_sleep (800);
+
+  for (i = 0; i < TEST_CNT; i++) 
+    {
+      struct wheel_test *t = &tests[i];
+
+      if (t->cancel)
+        {
+          if (t->ran != -1)
+            fail ("cancelled timer %d ran at tick %lld", i,
+                  (long long) (t->ran - start));
+          msg ("Timer due at +%d was cancelled.", offsets[i]);
+        }
+      else if (offsets[i] < 0)
+        {
+          if (t->ran == -1 || t->ran > start + 1)
+            fail ("overdue timer ran at +%lld", (long long) (t->ran - start));
+          msg ("Overdue timer ran at once.");
+        }
+      else
+        {
+          if (t->ran != t->expires)
+            fail ("timer %d due at +%lld ran at +%lld", i,
+                  (long long) (t->expires - start),
+                  (long long) (t->ran - start));
+          if (timer_pending (&t->timer))
+            fail ("timer %d is still pending", i);
+          msg ("Timer due at +%lld ran on time.",
+               (long long) (t->expires - start));
+        }
+    }
+  pass ();
+}
+
+/* Timer callback that records the current tick in T_. */
+static void
+record (void *t_) 
+{
+  struct wheel_test *t = t_;
+
+  t->ran = timer_ticks ();
+  if (t->readd)
+    {
+      t->readd = false;
+      t->expires += 50;
+      timer_add (&t->timer, record, t, t->expires);
+    }
+}
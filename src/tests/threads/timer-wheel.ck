@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(timer-wheel) begin
+(timer-wheel) Sleeping 8 seconds, please wait...
+(timer-wheel) Timer due at +1 ran on time.
+(timer-wheel) Timer due at +52 ran on time.
+(timer-wheel) Timer due at +100 was cancelled.
+(timer-wheel) Timer due at +255 ran on time.
+(timer-wheel) Timer due at +256 ran on time.
+(timer-wheel) Timer due at +300 ran on time.
+(timer-wheel) Timer due at +700 was cancelled.
+(timer-wheel) Overdue timer ran at once.
+(timer-wheel) PASS
+(timer-wheel) end
+EOF
+pass;
@@ -0,0 +1,69 @@
+/* Queues bursts of work items, once with interrupts on and once
+   with them off, as an interrupt handler would, and checks that
+   flush_work() returns only after all of them have run and that
+   an item cannot be queued twice while it is pending. */
+
+#include <stdio.h>
+#include "tests/threads/tests.h"
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "threads/workqueue.h"
+
+#define WORK_CNT 64             /* Number of items queued directly. */
+
+static struct work items[WORK_CNT];
+static int run_cnt;             /* # of times count_work() ran. */
+
+static work_func count_work;
+
+void
+test_workqueue (void) 
+{
+  enum intr_level old_level;
+  int i;
+
+  for (i = 0; i < WORK_CNT; i++)
+    work_init (&items[i], count_work);
+
+  msg ("Queueing %d items.", WORK_CNT);
+  for (i = 0; i < WORK_CNT; i++)
+    if (!queue_work (&items[i]))
+      fail ("item %d was reported as already queued", i);
+
+  flush_work ();
+  old_level = intr_disable ();
+  i = run_cnt;
+  intr_set_level (old_level);
+  if (i != WORK_CNT)
+    fail ("%d items ran before flush_work() returned, expected %d",
+          i, WORK_CNT);
+
+  msg ("Queueing each item twice in a row.");
+  old_level = intr_disable ();
+  run_cnt = 0;
+  for (i = 0; i < WORK_CNT; i++)
+    {
+      queue_work (&items[i]);
+      if (queue_work (&items[i]))
+        fail ("pending item %d was queued twice", i);
+    }
+  intr_set_level (old_level);
+
+  flush_work ();
+  old_level = intr_disable ();
+  i = run_cnt;
+  intr_set_level (old_level);
+  if (i != WORK_CNT)
+    fail ("%d items ran, expected %d", i, WORK_CNT);
+
+  pass ();
+}
+
+/* Work function that counts how many times it has run. */
+static void
+count_work (struct work *w UNUSED) 
+{
+  enum intr_level old_level = intr_disable ();
+  run_cnt++;
+  intr_set_level (old_level);
+}
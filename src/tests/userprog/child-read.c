@@ -0,0 +1,36 @@
+/* Child process run by the read-par test.
+   Reads the file named by its first argument from the beginning
+   as many times as its second argument says, then terminates. */
+
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+int
+main (int argc, char *argv[]) 
+{
+  char buffer[512];
+  int handle;
+  int size;
+  int iter_cnt;
+  int i;
+
+  test_name = "child-read";
+
+  if (argc != 3)
+    fail ("wrong number of arguments");
+  iter_cnt = atoi (argv[2]);
+  if ((handle = open (argv[1])) < 2)
+    fail ("open \"%s\"", argv[1]);
+  size = filesize (handle);
+  if (size <= 0 || size > (int) sizeof buffer)
+    fail ("\"%s\" is %d bytes long", argv[1], size);
+
+  for (i = 0; i < iter_cnt; i++) 
+    {
+      seek (handle, 0);
+      if (read (handle, buffer, size) != size)
+        fail ("read \"%s\"", argv[1]);
+    }
+  return 83;
+}
@@ -0,0 +1,20 @@
+/* Child process run by the wait-timeout test.
+   Spins until it has used half a second of CPU time, so that it
+   is still running when its parent's first, short wait times
+   out, then terminates. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+
+int
+main (void) 
+{
+  struct rusage usage;
+
+  test_name = "child-spin";
+
+  do
+    getrusage (RUSAGE_SELF, &usage);
+  while (usage.user_ticks + usage.kernel_ticks < 50);
+  return 82;
+}
@@ -0,0 +1,20 @@
+/* Opens a file, closes it, and then tries to read from the
+   closed handle.  The read must either fail or terminate the
+   process with exit code -1. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buffer[16];
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  msg ("close \"sample.txt\"");
+  close (handle);
+  CHECK (read (handle, buffer, sizeof buffer) == -1,
+         "read from closed handle fails");
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF', <<'EOF']);
+(close-read) begin
+(close-read) open "sample.txt"
+(close-read) close "sample.txt"
+(close-read) read from closed handle fails
+(close-read) end
+close-read: exit(0)
+EOF
+(close-read) begin
+(close-read) open "sample.txt"
+(close-read) close "sample.txt"
+(close-read) read from closed handle fails
+close-read: exit(-1)
+EOF
+pass;
@@ -0,0 +1,32 @@
+/* Exercises futex_wait() and futex_wake() within one process:
+   waiting on a word that does not hold the expected value
+   returns at once, waiting with a timeout returns when it
+   expires, and waking a futex nobody waits on wakes nobody.
+   Actually waking a waiter needs a second thread that can reach
+   the same word, which needs threads or shared memory.  Pintos
+   has neither, so that path is not tested here, and a wait
+   without a timeout, which could never end, must fail. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static int word;
+
+void
+test_main (void) 
+{
+  char *misaligned = (char *) &word + 1;
+
+  CHECK (futex_wait (&word, 1, 50) == FUTEX_CHANGED,
+         "futex_wait on a changed word returns FUTEX_CHANGED");
+  CHECK (futex_wait (&word, 0, FUTEX_FOREVER) == -1,
+         "futex_wait without a timeout fails");
+  CHECK (futex_wait (&word, 0, 0) == FUTEX_TIMEOUT,
+         "futex_wait with zero timeout returns FUTEX_TIMEOUT");
+  CHECK (futex_wait (&word, 0, 50) == FUTEX_TIMEOUT,
+         "futex_wait with 50 ms timeout returns FUTEX_TIMEOUT");
+  CHECK (futex_wake (&word, 1) == 0, "futex_wake with no waiters wakes 0");
+  CHECK (futex_wait ((int *) misaligned, 0, 0) == -1,
+         "futex_wait on a misaligned word fails");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(futex) begin
+(futex) futex_wait on a changed word returns FUTEX_CHANGED
+(futex) futex_wait without a timeout fails
+(futex) futex_wait with zero timeout returns FUTEX_TIMEOUT
+(futex) futex_wait with 50 ms timeout returns FUTEX_TIMEOUT
+(futex) futex_wake with no waiters wakes 0
+(futex) futex_wait on a misaligned word fails
+(futex) end
+futex: exit(0)
+EOF
+pass;
@@ -0,0 +1,34 @@
+/* Checks that getrusage() counts the caller's own system calls
+   and reports the usage of a child once it has been waited for. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct rusage before, after, children;
+  int i;
+
+  CHECK (getrusage (RUSAGE_SELF, &before) == 0, "getrusage (RUSAGE_SELF)");
+  for (i = 0; i < 10; i++)
+    tell (0x20101234);
+  CHECK (getrusage (RUSAGE_SELF, &after) == 0, "getrusage (RUSAGE_SELF)");
+  if (after.syscalls - before.syscalls != 11)
+    fail ("counted %d system calls, expected 11",
+          (int) (after.syscalls - before.syscalls));
+
+  CHECK (getrusage (RUSAGE_CHILDREN, &children) == 0,
+         "getrusage (RUSAGE_CHILDREN)");
+  if (children.syscalls != 0)
+    fail ("children made system calls before any were started");
+
+  msg ("wait(exec()) = %d", wait (exec ("child-simple")));
+  CHECK (getrusage (RUSAGE_CHILDREN, &children) == 0,
+         "getrusage (RUSAGE_CHILDREN)");
+  if (children.syscalls == 0)
+    fail ("waited-for child made no system calls");
+
+  CHECK (getrusage (2, &children) == -1, "getrusage (2) must fail");
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(getrusage) begin
+(getrusage) getrusage (RUSAGE_SELF)
+(getrusage) getrusage (RUSAGE_SELF)
+(getrusage) getrusage (RUSAGE_CHILDREN)
+(child-simple) run
+child-simple: exit(81)
+(getrusage) wait(exec()) = 81
+(getrusage) getrusage (RUSAGE_CHILDREN)
+(getrusage) getrusage (2) must fail
+(getrusage) end
+getrusage: exit(0)
+EOF
+pass;
@@ -0,0 +1,29 @@
+/* Opens "sample.txt" enough times that the file descriptor table
+   must grow, closes one handle in the middle, and verifies that
+   the next open() reuses that descriptor and that handles opened
+   before the table grew still work. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define HANDLE_CNT 100
+
+void
+test_main (void) 
+{
+  int handles[HANDLE_CNT];
+  char buffer[16];
+  int i;
+
+  for (i = 0; i < HANDLE_CNT; i++)
+    if ((handles[i] = open ("sample.txt")) < 2)
+      fail ("open #%d returned %d", i, handles[i]);
+  msg ("open \"sample.txt\" %d times", HANDLE_CNT);
+
+  close (handles[HANDLE_CNT / 2]);
+  CHECK (open ("sample.txt") == handles[HANDLE_CNT / 2],
+         "open after close reuses the closed handle");
+  CHECK (read (handles[0], buffer, sizeof buffer) == sizeof buffer,
+         "read from first handle");
+}
@@ -0,0 +1,31 @@
+/* Measures how quickly a parent and its children can hand the
+   CPU back and forth.  Runs child-simple to completion as many
+   times as it can while child-spin competes for the CPU, each
+   exec() and wait() being a round trip between two processes.
+
+   Built twice: pingpong runs with the default scheduler and
+   pingpong-handoff with kernel option -handoff, so their counts
+   can be compared. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t spinner;
+  int status;
+  int cnt = 0;
+
+  CHECK ((spinner = exec ("child-spin")) != -1, "exec \"child-spin\"");
+  do
+    {
+      if (wait (exec ("child-simple")) != 81)
+        fail ("wait(exec(\"child-simple\")) did not return 81");
+      cnt++;
+    }
+  while (wait_timeout (spinner, 0, &status) == WAIT_TIMEOUT);
+  CHECK (status == 82, "child-spin exit status is 82");
+  msg ("%d round trips while child-spin ran", cnt);
+}
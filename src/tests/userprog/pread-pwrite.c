@@ -0,0 +1,38 @@
+/* Reads "sample.txt" with pread() at a few offsets, checking that
+   the file position does not move, then builds "test.txt" back to
+   front with pwrite() and verifies it. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  size_t size = sizeof sample - 1;
+  size_t half = size / 2;
+  char buffer[sizeof sample];
+  int handle;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (pread (handle, buffer, 10, 20) == 10, "pread 10 bytes at offset 20");
+  compare_bytes (buffer, sample + 20, 10, 20, "sample.txt");
+  CHECK (pread (handle, buffer, size, 100) == (int) size - 100,
+         "pread past end of file is short");
+  compare_bytes (buffer, sample + 100, size - 100, 100, "sample.txt");
+  CHECK (tell (handle) == 0, "file position is still 0");
+  CHECK (pread (handle, buffer, 10, -1) == -1,
+         "pread at negative offset fails");
+  close (handle);
+
+  CHECK (create ("test.txt", size), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+  CHECK (pwrite (handle, sample + half, size - half, half)
+         == (int) (size - half), "pwrite second half");
+  CHECK (pwrite (handle, sample, half, 0) == (int) half, "pwrite first half");
+  CHECK (tell (handle) == 0, "file position is still 0");
+  close (handle);
+
+  check_file ("test.txt", sample, size);
+}
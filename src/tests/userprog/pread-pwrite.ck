@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pread-pwrite) begin
+(pread-pwrite) open "sample.txt"
+(pread-pwrite) pread 10 bytes at offset 20
+(pread-pwrite) pread past end of file is short
+(pread-pwrite) file position is still 0
+(pread-pwrite) pread at negative offset fails
+(pread-pwrite) create "test.txt"
+(pread-pwrite) open "test.txt"
+(pread-pwrite) pwrite second half
+(pread-pwrite) pwrite first half
+(pread-pwrite) file position is still 0
+(pread-pwrite) open "test.txt" for verification
+(pread-pwrite) verified contents of "test.txt"
+(pread-pwrite) close "test.txt"
+(pread-pwrite) end
+pread-pwrite: exit(0)
+EOF
+pass;
@@ -0,0 +1,95 @@
+/* Measures how reads by several processes at once scale.  Times
+   READ_CNT reads of "sample.txt" done by one child-read process,
+   then split among READER_CNT of them all reading "sample.txt",
+   then split among READER_CNT of them each reading its own copy
+   of it.  read-par.ck fails if either split run takes much longer
+   than the single reader.
+
+   There is no buffer cache, so every read goes to the disk, and
+   one IDE channel serves one request at a time.  Splitting a
+   fixed amount of reading among processes therefore cannot make
+   it much faster.  What the test checks is that it does not make
+   it slower: readers of the same file or of different files must
+   not queue behind each other's disk waits on a file system lock,
+   and processes blocked on the disk must let others run.
+
+   Time is measured by waiting for the children with a one-tick
+   timeout and counting the timeouts, so it is only accurate to
+   a tick per child. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/userprog/sample.inc"
+
+/* Number of readers run at once. */
+#define READER_CNT 4
+
+/* Total number of reads in each run.  A multiple of READER_CNT. */
+#define READ_CNT 800
+
+/* Timeout for each wait, in milliseconds.  One tick at the
+   default timer frequency. */
+#define WAIT_MS 10
+
+/* Runs a child-read process for each of the CNT files in FILES,
+   all at once, each doing its share of READ_CNT reads, and
+   returns about how many milliseconds it took for all of them to
+   finish. */
+static int
+run_readers (const char *files[], int cnt) 
+{
+  pid_t pids[READER_CNT];
+  int elapsed = 0;
+  int i;
+
+  for (i = 0; i < cnt; i++) 
+    {
+      char cmd[32];
+
+      snprintf (cmd, sizeof cmd, "child-read %s %d", files[i],
+                READ_CNT / cnt);
+      if ((pids[i] = exec (cmd)) == PID_ERROR)
+        fail ("exec \"%s\"", cmd);
+    }
+  for (i = 0; i < cnt; i++) 
+    {
+      int status;
+
+      while (wait_timeout (pids[i], WAIT_MS, &status) == WAIT_TIMEOUT)
+        elapsed += WAIT_MS;
+      if (status != 83)
+        fail ("child-read %s exit status is %d, not 83", files[i], status);
+    }
+  return elapsed;
+}
+
+void
+test_main (void) 
+{
+  static const char *same[READER_CNT] =
+    {"sample.txt", "sample.txt", "sample.txt", "sample.txt"};
+  static const char *own[READER_CNT] = {"a", "b", "c", "d"};
+  int i;
+
+  for (i = 0; i < READER_CNT; i++) 
+    {
+      int handle;
+
+      if (!create (own[i], sizeof sample - 1))
+        fail ("create \"%s\"", own[i]);
+      if ((handle = open (own[i])) < 2)
+        fail ("open \"%s\"", own[i]);
+      if (write (handle, sample, sizeof sample - 1) != sizeof sample - 1)
+        fail ("write \"%s\"", own[i]);
+      close (handle);
+    }
+  msg ("created %d copies of \"sample.txt\"", READER_CNT);
+
+  msg ("1 reader: about %d ms", run_readers (same, 1));
+  msg ("%d readers, same file: about %d ms",
+       READER_CNT, run_readers (same, READER_CNT));
+  msg ("%d readers, own files: about %d ms",
+       READER_CNT, run_readers (own, READER_CNT));
+}
@@ -0,0 +1,36 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+our ($test);
+my (@output) = read_text_file ("$test.output");
+
+common_checks ("run", @output);
+
+@output = get_core_output ("run", @output);
+fail "missing end in output"
+  unless grep ($_ eq '(read-par) end', @output);
+
+# Parse the time of each run.
+my ($single, $same, $own);
+foreach (@output) {
+    $single = $1 if /^\(read-par\) 1 reader: about (\d+) ms$/;
+    $same = $1 if /^\(read-par\) \d+ readers, same file: about (\d+) ms$/;
+    $own = $1 if /^\(read-par\) \d+ readers, own files: about (\d+) ms$/;
+}
+fail "missing run times in output"
+  unless defined ($single) && defined ($same) && defined ($own);
+
+# The same reads split among 4 processes must take no more than
+# twice as long as one process doing them all.  The times are
+# accurate to about a 10 ms tick per reader, so allow for that.
+my ($limit) = 2 * $single + 4 * 10;
+fail "4 readers of the same file took $same ms, more than $limit ms "
+  . "(1 reader took $single ms)\n"
+  if $same > $limit;
+fail "4 readers of their own files took $own ms, more than $limit ms "
+  . "(1 reader took $single ms)\n"
+  if $own > $limit;
+
+pass;
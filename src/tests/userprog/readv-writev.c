@@ -0,0 +1,54 @@
+/* Writes "test.txt" from three buffers with one writev(), reads
+   it back into two buffers with one readv(), with an empty entry
+   with a null base between them, and writes a message to the
+   console from two buffers. */
+
+#include <stdio.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char console[] = "(readv-writev) writev to console\n";
+  size_t size = sizeof sample - 1;
+  char head[50], tail[sizeof sample];
+  struct iovec iov[3];
+  int handle;
+
+  CHECK (create ("test.txt", size), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+  iov[0].iov_base = sample;
+  iov[0].iov_len = 10;
+  iov[1].iov_base = sample + 10;
+  iov[1].iov_len = 100;
+  iov[2].iov_base = sample + 110;
+  iov[2].iov_len = size - 110;
+  CHECK (writev (handle, iov, 3) == (int) size, "writev 3 buffers");
+  CHECK (tell (handle) == size, "file position is at end of file");
+
+  seek (handle, 0);
+  iov[0].iov_base = head;
+  iov[0].iov_len = sizeof head;
+  iov[1].iov_base = NULL;
+  iov[1].iov_len = 0;
+  iov[2].iov_base = tail;
+  iov[2].iov_len = sizeof tail;
+  CHECK (readv (handle, iov, 3) == (int) size,
+         "readv 2 buffers and an empty one, last one short");
+  compare_bytes (head, sample, sizeof head, 0, "test.txt");
+  compare_bytes (tail, sample + sizeof head, size - sizeof head,
+                 sizeof head, "test.txt");
+  CHECK (tell (handle) == size, "file position is at end of file");
+  close (handle);
+
+  iov[0].iov_base = console;
+  iov[0].iov_len = 15;
+  iov[1].iov_base = console + 15;
+  iov[1].iov_len = strlen (console) - 15;
+  if (writev (STDOUT_FILENO, iov, 2) != (int) strlen (console))
+    fail ("writev to console");
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(readv-writev) begin
+(readv-writev) create "test.txt"
+(readv-writev) open "test.txt"
+(readv-writev) writev 3 buffers
+(readv-writev) file position is at end of file
+(readv-writev) readv 2 buffers and an empty one, last one short
+(readv-writev) file position is at end of file
+(readv-writev) writev to console
+(readv-writev) end
+readv-writev: exit(0)
+EOF
+pass;
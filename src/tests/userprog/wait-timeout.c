@@ -0,0 +1,25 @@
+/* Waits for a busy child with a timeout that expires first, then
+   without a timeout, which returns the child's exit status.  A
+   third wait fails, as it would for wait(). */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  pid_t child;
+  int status = -1;
+
+  CHECK (wait_timeout (-1, 0, &status) == -1,
+         "wait_timeout on a bad pid fails");
+  CHECK ((child = exec ("child-spin")) != -1, "exec \"child-spin\"");
+  CHECK (wait_timeout (child, 10, &status) == WAIT_TIMEOUT,
+         "wait_timeout with 10 ms timeout returns WAIT_TIMEOUT");
+  CHECK (wait_timeout (child, WAIT_FOREVER, &status) == WAIT_EXITED,
+         "wait_timeout without timeout returns WAIT_EXITED");
+  CHECK (status == 82, "exit status is 82");
+  CHECK (wait_timeout (child, 0, &status) == -1,
+         "wait_timeout on a waited-for child fails");
+}
@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(wait-timeout) begin
+(wait-timeout) wait_timeout on a bad pid fails
+(wait-timeout) exec "child-spin"
+(wait-timeout) wait_timeout with 10 ms timeout returns WAIT_TIMEOUT
+child-spin: exit(82)
+(wait-timeout) wait_timeout without timeout returns WAIT_EXITED
+(wait-timeout) exit status is 82
+(wait-timeout) wait_timeout on a waited-for child fails
+(wait-timeout) end
+wait-timeout: exit(0)
+EOF
+pass;
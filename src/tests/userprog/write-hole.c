@@ -0,0 +1,20 @@
+/* Passes the write system call a buffer that starts in the data
+   segment and ends on the stack, so that its first and last
+   bytes are valid but the pages between them are not mapped.
+   The process must be terminated with -1 exit code. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char data[] = "data";
+
+void
+test_main (void) 
+{
+  char stack = 's';
+
+  write (STDOUT_FILENO, data, &stack - data + 1);
+  fail ("should have exited with -1");
+}
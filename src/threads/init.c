@@ -22,6 +22,9 @@
 #include "threads/palloc.h"
 #include "threads/pte.h"
 #include "threads/thread.h"
+#include "threads/lockprof.h"
+#include "threads/trace.h"
+#include "threads/workqueue.h"
 #ifdef USERPROG
 #include "userprog/process.h"
 #include "userprog/exception.h"
@@ -119,6 +122,7 @@ main (void)
   thread_start ();
   serial_init_queue ();
   timer_calibrate ();
+  workqueue_init ();
 
 #ifdef FILESYS
   /* Initialize file system. */
@@ -255,14 +259,55 @@ parse_options (char **argv)
       else if (!strcmp (name, "-rs"))
         random_init (atoi (value));
       else if (!strcmp (name, "-mlfqs"))
-        thread_mlfqs = true;
+        thread_sched = SCHED_MLFQS;
+      else if (!strcmp (name, "-sched"))
+        {
+          if (value == NULL)
+            PANIC ("missing scheduler for `-sched' (use -h for help)");
+          else if (!strcmp (value, "priority"))
+            thread_sched = SCHED_PRIORITY;
+          else if (!strcmp (value, "mlfqs"))
+            thread_sched = SCHED_MLFQS;
+          else if (!strcmp (value, "stride"))
+            thread_sched = SCHED_STRIDE;
+          else if (!strcmp (value, "cfs"))
+            thread_sched = SCHED_CFS;
+          else
+            PANIC ("unknown scheduler `%s' (use -h for help)", value);
+        }
+      else if (!strcmp (name, "-hz"))
+        {
+          timer_freq = atoi (value);
+          if (timer_freq < TIMER_FREQ_MIN || timer_freq > TIMER_FREQ_MAX)
+            PANIC ("timer frequency must be between %d and %d Hz",
+                   TIMER_FREQ_MIN, TIMER_FREQ_MAX);
+        }
+      else if (!strcmp (name, "-slice"))
+        {
+          thread_time_slice = atoi (value);
+          if (thread_time_slice < 1 || thread_time_slice > SLICE_MAX)
+            PANIC ("time slice must be between 1 and %d ticks", SLICE_MAX);
+        }
+      else if (!strcmp (name, "-handoff"))
+        thread_handoff = true;
+      else if (!strcmp (name, "-tickless"))
+        timer_tickless = true;
+      else if (!strcmp (name, "-trace"))
+        trace_enabled = true;
+      else if (!strcmp (name, "-lockprof"))
+        lockprof_enabled = true;
+      else if (!strcmp (name, "-workers"))
+        workqueue_workers = atoi (value);
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
+      else if (!strcmp (name, "-sysprof"))
+        syscall_profile = true;
 #endif
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
     }
+  thread_mlfqs = thread_sched == SCHED_MLFQS;
 
   /* Initialize the random number generator based on the system
      time.  This has no effect if an "-rs" option was specified.
@@ -379,8 +424,18 @@ usage (void)
 #endif
           "  -rs=SEED           Set random number seed to SEED.\n"
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
+          "  -sched=POLICY      Use scheduler POLICY: priority (default),\n"
+          "                     mlfqs, stride, or cfs.\n"
+          "  -hz=N              Take N timer interrupts per second (default 100).\n"
+          "  -slice=N           Preempt threads after N ticks (default 4).\n"
+          "  -handoff           Run threads woken by sema_up() next.\n"
+          "  -tickless          Stop the timer tick while the CPU is idle.\n"
+          "  -trace             Record scheduler events, print at shutdown.\n"
+          "  -lockprof          Profile lock contention, print at shutdown.\n"
+          "  -workers=N         Start N work queue threads (default 2).\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+          "  -sysprof           Profile system calls, print at shutdown.\n"
 #endif
           );
   shutdown_power_off ();
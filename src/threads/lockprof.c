@@ -0,0 +1,170 @@
+#include "threads/lockprof.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/tsc.h"
+
+/* Lock contention profiler.
+
+   lock_acquire() and lock_release() report to this module when
+   lockprof_enabled is set.  Statistics are kept per lock site,
+   that is, per pair of lock name (see lock_init()) and address of
+   the code that acquired the lock, in a fixed-size hash table
+   that is updated with interrupts off.  lockprof_print_stats()
+   prints the sites that spent the most time waiting.  The code
+   addresses can be turned into function names with the
+   `backtrace' utility.
+
+   An rwlock is profiled through its internal lock, which takes
+   the rwlock's name.  Each rwlock operation is recorded against
+   the code that called the rwlock function, and time spent
+   waiting for readers or a writer to leave counts as waiting.  A
+   thread that has to wait is recorded as acquiring the internal
+   lock twice, once on the way in and again on waking up. */
+
+/* Number of sites kept.  Must be a power of 2. */
+#define SITE_CNT 256
+
+/* Number of sites printed by lockprof_print_stats(). */
+#define TOP_CNT 10
+
+/* Statistics for one lock site. */
+struct lock_site
+  {
+    const char *name;           /* Lock name, or null if unused. */
+    const void *site;           /* Return address of lock_acquire(). */
+    uint64_t acquire_cnt;       /* Times acquired. */
+    uint64_t contended_cnt;     /* Times the lock was already held. */
+    uint64_t wait_cycles;       /* Total cycles spent waiting. */
+    uint64_t max_hold_cycles;   /* Longest time held. */
+  };
+
+/* If false (default), lock acquisitions are not profiled.
+   Controlled by kernel command-line option "-lockprof". */
+bool lockprof_enabled;
+
+static struct lock_site sites[SITE_CNT];
+static int site_cnt;            /* # of sites in use. */
+static uint64_t dropped_cnt;    /* Acquisitions not recorded. */
+
+static int find_site (const char *name, const void *site);
+static int compare_wait (const void *, const void *);
+
+/* Records that LOCK has just been acquired by code at SITE.
+   CONTENDED tells whether LOCK was held by another thread when
+   the current one tried to acquire it, and WAIT_START is the
+   time stamp counter at that point.  Must be called with
+   interrupts off. */
+void
+lockprof_acquired (struct lock *lock, const void *site, bool contended,
+                   uint64_t wait_start) 
+{
+  uint64_t now = rdtsc ();
+  struct lock_site *s;
+  int idx;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  idx = find_site (lock->name, site);
+  lock->prof_site = idx;
+  lock->prof_acquired = now;
+  if (idx < 0)
+    {
+      dropped_cnt++;
+      return;
+    }
+
+  s = &sites[idx];
+  s->acquire_cnt++;
+  if (contended)
+    s->contended_cnt++;
+  if (wait_start != 0)
+    s->wait_cycles += now - wait_start;
+}
+
+/* Records that LOCK is being released.  Must be called with
+   interrupts off. */
+void
+lockprof_released (struct lock *lock) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (lock->prof_site >= 0)
+    {
+      struct lock_site *s = &sites[lock->prof_site];
+      uint64_t held = rdtsc () - lock->prof_acquired;
+
+      if (held > s->max_hold_cycles)
+        s->max_hold_cycles = held;
+      lock->prof_site = -1;
+    }
+}
+
+/* Stops profiling and prints the TOP_CNT sites that spent the
+   most cycles waiting. */
+void
+lockprof_print_stats (void) 
+{
+  enum intr_level old_level;
+  int i;
+
+  /* Stop recording, so that printing doesn't profile the
+     console lock, and sort the sites in place. */
+  old_level = intr_disable ();
+  lockprof_enabled = false;
+  intr_set_level (old_level);
+  qsort (sites, SITE_CNT, sizeof *sites, compare_wait);
+
+  printf ("Lock profile: %d sites, %"PRIu64" acquisitions not recorded\n",
+          site_cnt, dropped_cnt);
+  for (i = 0; i < TOP_CNT && i < site_cnt; i++) 
+    {
+      struct lock_site *s = &sites[i];
+      printf ("Lock: %s at %p: %"PRIu64" acquired, %"PRIu64" contended, "
+              "%"PRIu64" cycles waiting, %"PRIu64" max cycles held\n",
+              s->name, s->site, s->acquire_cnt, s->contended_cnt,
+              s->wait_cycles, s->max_hold_cycles);
+    }
+}
+
+/* Returns the index of the site for the lock named NAME acquired
+   at SITE, adding it if necessary, or -1 if the table is full. */
+static int
+find_site (const char *name, const void *site) 
+{
+  unsigned h = ((uintptr_t) name ^ (uintptr_t) site * 31) >> 2;
+  int i;
+
+  for (i = 0; i < SITE_CNT; i++) 
+    {
+      struct lock_site *s = &sites[(h + i) & (SITE_CNT - 1)];
+      if (s->name == NULL) 
+        {
+          s->name = name;
+          s->site = site;
+          site_cnt++;
+          return s - sites;
+        }
+      if (s->name == name && s->site == site)
+        return s - sites;
+    }
+  return -1;
+}
+
+/* Orders lock sites A_ and B_ by decreasing wait time.  Unused
+   sites sort last. */
+static int
+compare_wait (const void *a_, const void *b_) 
+{
+  const struct lock_site *a = a_;
+  const struct lock_site *b = b_;
+
+  if (a->name == NULL || b->name == NULL)
+    return (a->name == NULL) - (b->name == NULL);
+  if (a->wait_cycles != b->wait_cycles)
+    return a->wait_cycles < b->wait_cycles ? 1 : -1;
+  return 0;
+}
@@ -0,0 +1,18 @@
+#ifndef THREADS_LOCKPROF_H
+#define THREADS_LOCKPROF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+struct lock;
+
+/* If false (default), lock acquisitions are not profiled.
+   Controlled by kernel command-line option "-lockprof". */
+extern bool lockprof_enabled;
+
+void lockprof_acquired (struct lock *, const void *site, bool contended,
+                        uint64_t wait_start);
+void lockprof_released (struct lock *);
+void lockprof_print_stats (void);
+
+#endif /* threads/lockprof.h */
@@ -30,7 +30,20 @@
 #include <stdio.h>
 #include <string.h>
 #include "threads/interrupt.h"
+#include "threads/lockprof.h"
 #include "threads/thread.h"
+#include "threads/tsc.h"
+#include "devices/timer.h"
+
+/** Maximum number of locks that a priority donation follows
+   through a chain of lock holders waiting on other locks. */
+#define DONATION_DEPTH_MAX 8
+
+static bool priority_less (const struct list_elem *,
+                           const struct list_elem *, void *aux);
+static void donate_priority (struct thread *);
+static bool acquire (struct lock *, bool timed, int64_t ticks,
+                     const void *site, uint64_t waited_since);
 
 /** Initializes semaphore SEMA to VALUE.  A semaphore is a
    nonnegative integer along with two atomic operators for
@@ -75,6 +88,37 @@ sema_down (struct semaphore *sema)
   intr_set_level (old_level);
 }
 
+/** Like sema_down(), but gives up once TICKS timer ticks have
+   passed without the semaphore becoming positive.  Returns true
+   if SEMA was decremented, false if the wait timed out.  If
+   TICKS is not positive, only tries once, like sema_try_down().
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+bool
+sema_down_timeout (struct semaphore *sema, int64_t ticks) 
+{
+  int64_t deadline = timer_ticks () + ticks;
+  enum intr_level old_level;
+
+  ASSERT (sema != NULL);
+  ASSERT (!intr_context ());
+
+  old_level = intr_disable ();
+  while (sema->value == 0) 
+    {
+      list_push_back (&sema->waiters, &thread_current ()->elem);
+      if (timer_block_timeout (deadline))
+        {
+          intr_set_level (old_level);
+          return false;
+        }
+    }
+  sema->value--;
+  intr_set_level (old_level);
+  return true;
+}
+
 /** Down or "P" operation on a semaphore, but only if the
    semaphore is not already 0.  Returns true if the semaphore is
    decremented, false otherwise.
@@ -102,7 +146,12 @@ sema_try_down (struct semaphore *sema)
 }
 
 /** Up or "V" operation on a semaphore.  Increments SEMA's value
-   and wakes up one thread of those waiting for SEMA, if any.
+   and wakes up the highest-priority thread of those waiting for
+   SEMA, if any, picking the longest waiter among equals.  If the
+   woken thread has a higher priority than the running thread,
+   the running thread yields to it.  Otherwise, if thread_handoff
+   is on, the woken thread runs as soon as the running thread
+   blocks or yields.
 
    This function may be called from an interrupt handler. */
 void
@@ -114,10 +163,17 @@ sema_up (struct semaphore *sema)
 
   old_level = intr_disable ();
   if (!list_empty (&sema->waiters)) 
-    thread_unblock (list_entry (list_pop_front (&sema->waiters),
-                                struct thread, elem));
+    {
+      struct list_elem *e = list_max (&sema->waiters, priority_less, NULL);
+      struct thread *t = list_entry (e, struct thread, elem);
+
+      list_remove (e);
+      thread_unblock (t);
+      thread_hint_handoff (t);
+    }
   sema->value++;
   intr_set_level (old_level);
+  thread_check_preempt ();
 }
 
 static void sema_test_helper (void *sema_);
@@ -171,20 +227,34 @@ sema_test_helper (void *sema_)
    another one "up" it, but with a lock the same thread must both
    acquire and release it.  When these restrictions prove
    onerous, it's a good sign that a semaphore should be used,
-   instead of a lock. */
+   instead of a lock.
+
+   NAME identifies the lock in the lock profiler's report.  The
+   lock_init() macro supplies it automatically. */
 void
-lock_init (struct lock *lock)
+lock_init_named (struct lock *lock, const char *name)
 {
   ASSERT (lock != NULL);
+  ASSERT (name != NULL);
 
   lock->holder = NULL;
   sema_init (&lock->semaphore, 1);
+  lock->name = name;
+  lock->prof_site = -1;
 }
 
 /** Acquires LOCK, sleeping until it becomes available if
    necessary.  The lock must not already be held by the current
    thread.
 
+   While waiting, the current thread donates its priority to the
+   lock's holder, and through it to the holders of any locks that
+   holder is itself waiting on, up to DONATION_DEPTH_MAX locks
+   deep.  Donation is not used under the MLFQS.
+
+   If the lock profiler is enabled, the acquisition is recorded
+   against the caller's address.
+
    This function may sleep, so it must not be called within an
    interrupt handler.  This function may be called with
    interrupts disabled, but interrupts will be turned back on if
@@ -192,12 +262,101 @@ lock_init (struct lock *lock)
 void
 lock_acquire (struct lock *lock)
 {
+  acquire (lock, false, 0, __builtin_return_address (0), 0);
+}
+
+/** Like lock_acquire(), but gives up once TICKS timer ticks have
+   passed without the lock becoming available.  Returns true if
+   the lock was acquired, false if the wait timed out, in which
+   case the current thread's priority donation to the holder is
+   withdrawn.  If TICKS is not positive, only tries once. */
+bool
+lock_acquire_timeout (struct lock *lock, int64_t ticks)
+{
+  return acquire (lock, true, ticks, __builtin_return_address (0), 0);
+}
+
+/** Acquires LOCK for lock_acquire() or, if TIMED, for
+   lock_acquire_timeout() with a timeout of TICKS.  SITE is the
+   caller's address, for the lock profiler.  If WAITED_SINCE is
+   nonzero, the caller has already been waiting for LOCK by other
+   means since that time stamp counter value, and the profiler
+   counts the acquisition as contended and all of that time as
+   waiting. */
+static bool
+acquire (struct lock *lock, bool timed, int64_t ticks, const void *site,
+         uint64_t waited_since)
+{
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+  uint64_t wait_start = 0;
+  bool contended = false;
+
   ASSERT (lock != NULL);
   ASSERT (!intr_context ());
   ASSERT (!lock_held_by_current_thread (lock));
 
-  sema_down (&lock->semaphore);
-  lock->holder = thread_current ();
+  old_level = intr_disable ();
+  if (lockprof_enabled)
+    {
+      wait_start = waited_since != 0 ? waited_since : rdtsc ();
+      contended = waited_since != 0 || lock->holder != NULL;
+    }
+  if (!thread_mlfqs)
+    {
+      cur->waiting_lock = lock;
+      if (lock->holder != NULL)
+        {
+          list_push_back (&lock->holder->donors, &cur->donor_elem);
+          donate_priority (cur);
+        }
+    }
+
+  if (!timed)
+    sema_down (&lock->semaphore);
+  else if (!sema_down_timeout (&lock->semaphore, ticks))
+    {
+      /* Withdraw our donation, from the holder and from every
+         holder further along the chain that it reached.  The
+         holder may have taken the lock without adopting us as a
+         donor, so look first. */
+      if (!thread_mlfqs && lock->holder != NULL)
+        {
+          struct list *donors = &lock->holder->donors;
+          struct list_elem *e;
+
+          for (e = list_begin (donors); e != list_end (donors);
+               e = list_next (e))
+            if (e == &cur->donor_elem)
+              {
+                list_remove (e);
+                donate_priority (cur);
+                break;
+              }
+        }
+      cur->waiting_lock = NULL;
+      intr_set_level (old_level);
+      return false;
+    }
+  cur->waiting_lock = NULL;
+  lock->holder = cur;
+  if (lockprof_enabled)
+    lockprof_acquired (lock, site, contended, wait_start);
+
+  /* Threads still waiting for LOCK now donate to us. */
+  if (!thread_mlfqs)
+    {
+      struct list *waiters = &lock->semaphore.waiters;
+      struct list_elem *e;
+
+      for (e = list_begin (waiters); e != list_end (waiters);
+           e = list_next (e))
+        list_push_back (&cur->donors,
+                        &list_entry (e, struct thread, elem)->donor_elem);
+      thread_update_priority (cur);
+    }
+  intr_set_level (old_level);
+  return true;
 }
 
 /** Tries to acquires LOCK and returns true if successful or false
@@ -210,17 +369,26 @@ bool
 lock_try_acquire (struct lock *lock)
 {
   bool success;
+  enum intr_level old_level;
 
   ASSERT (lock != NULL);
   ASSERT (!lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
   success = sema_try_down (&lock->semaphore);
   if (success)
-    lock->holder = thread_current ();
+    {
+      lock->holder = thread_current ();
+      if (lockprof_enabled)
+        lockprof_acquired (lock, __builtin_return_address (0), false, 0);
+    }
+  intr_set_level (old_level);
   return success;
 }
 
 /** Releases LOCK, which must be owned by the current thread.
+   Drops the priority donated by threads waiting for LOCK, which
+   may cause the current thread to yield.
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to release a lock within an interrupt
@@ -228,11 +396,32 @@ lock_try_acquire (struct lock *lock)
 void
 lock_release (struct lock *lock) 
 {
+  struct thread *cur = thread_current ();
+  enum intr_level old_level;
+
   ASSERT (lock != NULL);
   ASSERT (lock_held_by_current_thread (lock));
 
+  old_level = intr_disable ();
+  if (!thread_mlfqs)
+    {
+      struct list_elem *e = list_begin (&cur->donors);
+
+      while (e != list_end (&cur->donors))
+        {
+          struct thread *donor = list_entry (e, struct thread, donor_elem);
+          e = list_next (e);
+          if (donor->waiting_lock == lock)
+            list_remove (&donor->donor_elem);
+        }
+      thread_update_priority (cur);
+    }
+
+  if (lockprof_enabled)
+    lockprof_released (lock);
   lock->holder = NULL;
   sema_up (&lock->semaphore);
+  intr_set_level (old_level);
 }
 
 /** Returns true if the current thread holds LOCK, false
@@ -251,8 +440,12 @@ struct semaphore_elem
   {
     struct list_elem elem;              /**< List element. */
     struct semaphore semaphore;         /**< This semaphore. */
+    struct thread *thread;              /**< Thread waiting on it. */
   };
 
+static bool cond_priority_less (const struct list_elem *,
+                                const struct list_elem *, void *aux);
+
 /** Initializes condition variable COND.  A condition variable
    allows one piece of code to signal a condition and cooperating
    code to receive the signal and act upon it. */
@@ -295,15 +488,53 @@ cond_wait (struct condition *cond, struct lock *lock)
   ASSERT (lock_held_by_current_thread (lock));
   
   sema_init (&waiter.semaphore, 0);
+  waiter.thread = thread_current ();
   list_push_back (&cond->waiters, &waiter.elem);
   lock_release (lock);
   sema_down (&waiter.semaphore);
   lock_acquire (lock);
 }
 
+/** Like cond_wait(), but gives up once TICKS timer ticks have
+   passed without COND being signaled.  Either way, LOCK is
+   reacquired before returning.  Returns true if COND was
+   signaled, false if the wait timed out.  A signal that arrives
+   after the timeout but before LOCK is reacquired is not lost:
+   it counts as a successful wait. */
+bool
+cond_wait_timeout (struct condition *cond, struct lock *lock, int64_t ticks) 
+{
+  struct semaphore_elem waiter;
+  bool signaled;
+
+  ASSERT (cond != NULL);
+  ASSERT (lock != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (lock_held_by_current_thread (lock));
+  
+  sema_init (&waiter.semaphore, 0);
+  waiter.thread = thread_current ();
+  list_push_back (&cond->waiters, &waiter.elem);
+  lock_release (lock);
+  signaled = sema_down_timeout (&waiter.semaphore, ticks);
+  lock_acquire (lock);
+
+  /* cond_signal() takes the waiter off the list before upping
+     its semaphore, so if the semaphore is still 0 now that we
+     hold LOCK, we are still on the list. */
+  if (!signaled)
+    {
+      signaled = sema_try_down (&waiter.semaphore);
+      if (!signaled)
+        list_remove (&waiter.elem);
+    }
+  return signaled;
+}
+
 /** If any threads are waiting on COND (protected by LOCK), then
-   this function signals one of them to wake up from its wait.
-   LOCK must be held before calling this function.
+   this function signals the highest-priority one of them to wake
+   up from its wait.  LOCK must be held before calling this
+   function.
 
    An interrupt handler cannot acquire a lock, so it does not
    make sense to try to signal a condition variable within an
@@ -317,8 +548,12 @@ cond_signal (struct condition *cond, struct lock *lock UNUSED)
   ASSERT (lock_held_by_current_thread (lock));
 
   if (!list_empty (&cond->waiters)) 
-    sema_up (&list_entry (list_pop_front (&cond->waiters),
-                          struct semaphore_elem, elem)->semaphore);
+    {
+      struct list_elem *e = list_max (&cond->waiters, cond_priority_less,
+                                      NULL);
+      list_remove (e);
+      sema_up (&list_entry (e, struct semaphore_elem, elem)->semaphore);
+    }
 }
 
 /** Wakes up all threads, if any, waiting on COND (protected by
@@ -336,3 +571,324 @@ cond_broadcast (struct condition *cond, struct lock *lock)
   while (!list_empty (&cond->waiters))
     cond_signal (cond, lock);
 }
+
+/** Initializes readers-writer lock RW.  Any number of threads
+   may hold RW for reading at once, or one thread may hold it for
+   writing.
+
+   Writers are preferred: once a writer is waiting, newly arriving
+   readers wait behind it, so a steady stream of readers cannot
+   starve writers.  To keep writers from starving readers in
+   turn, a writer that releases RW lets in every reader that was
+   waiting at that moment before the next writer.
+
+   Waiters of each kind are woken highest priority first.
+   Priority is donated to a thread only while it holds RW's
+   internal lock, not for as long as it holds RW itself, because
+   there is no single holder to donate to while RW is read.
+
+   NAME identifies RW in the lock profiler's report, which
+   records each operation on RW against the code that called
+   it, and counts time spent waiting for readers or a writer to
+   leave as time spent waiting for RW.  The rwlock_init() macro
+   supplies NAME automatically. */
+void
+rwlock_init_named (struct rwlock *rw, const char *name)
+{
+  ASSERT (rw != NULL);
+
+  lock_init_named (&rw->lock, name);
+  cond_init (&rw->can_read);
+  cond_init (&rw->can_write);
+  rw->writer = NULL;
+  rw->readers = 0;
+  rw->waiting_readers = 0;
+  rw->waiting_writers = 0;
+  rw->read_batch = 0;
+}
+
+/** Returns true if a reader may enter RW now.  RW's internal lock
+   must be held. */
+static bool
+may_read (const struct rwlock *rw)
+{
+  return rw->writer == NULL && (rw->waiting_writers == 0
+                                || rw->read_batch > 0);
+}
+
+/** Returns true if a writer may enter RW now.  RW's internal lock
+   must be held. */
+static bool
+may_write (const struct rwlock *rw)
+{
+  return rw->writer == NULL && rw->readers == 0 && rw->read_batch == 0;
+}
+
+/** Acquires RW's internal lock for the rwlock function called
+   from SITE. */
+static void
+rw_lock (struct rwlock *rw, const void *site)
+{
+  acquire (&rw->lock, false, 0, site, 0);
+}
+
+/** Waits on COND, one of RW's condition variables, for the
+   rwlock function called from SITE.  Like cond_wait(), except
+   that the lock profiler sees RW's internal lock reacquired at
+   SITE and counts the whole wait, not just the reacquisition, as
+   time spent waiting for RW. */
+static void
+rw_wait (struct rwlock *rw, struct condition *cond, const void *site)
+{
+  struct semaphore_elem waiter;
+  uint64_t wait_start = lockprof_enabled ? rdtsc () : 0;
+
+  ASSERT (lock_held_by_current_thread (&rw->lock));
+
+  sema_init (&waiter.semaphore, 0);
+  waiter.thread = thread_current ();
+  list_push_back (&cond->waiters, &waiter.elem);
+  lock_release (&rw->lock);
+  sema_down (&waiter.semaphore);
+  acquire (&rw->lock, false, 0, site, wait_start);
+}
+
+/** Makes the current thread a reader of RW.  RW's internal lock
+   must be held and may_read() must be true. */
+static void
+enter_read (struct rwlock *rw)
+{
+  if (rw->read_batch > 0)
+    rw->read_batch--;
+  rw->readers++;
+}
+
+/** Acquires RW for reading, sleeping until no writer holds it or
+   is waiting for it if necessary.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_read (struct rwlock *rw)
+{
+  const void *site = __builtin_return_address (0);
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != thread_current ());
+
+  rw_lock (rw, site);
+  rw->waiting_readers++;
+  while (!may_read (rw))
+    rw_wait (rw, &rw->can_read, site);
+  rw->waiting_readers--;
+  enter_read (rw);
+  lock_release (&rw->lock);
+}
+
+/** Tries to acquire RW for reading without waiting for a writer.
+   Returns true if successful, false on failure.
+
+   RW's internal lock is still acquired, so this function must
+   not be called within an interrupt handler. */
+bool
+rwlock_try_acquire_read (struct rwlock *rw)
+{
+  bool success;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  rw_lock (rw, __builtin_return_address (0));
+  success = may_read (rw);
+  if (success)
+    enter_read (rw);
+  lock_release (&rw->lock);
+  return success;
+}
+
+/** Releases RW, which the current thread must hold for reading.
+   The last reader out lets a waiting writer in. */
+void
+rwlock_release_read (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  rw_lock (rw, __builtin_return_address (0));
+  ASSERT (rw->readers > 0);
+  rw->readers--;
+  if (may_write (rw) && rw->waiting_writers > 0)
+    cond_signal (&rw->can_write, &rw->lock);
+  lock_release (&rw->lock);
+}
+
+/** Acquires RW for writing, sleeping until no other thread holds
+   it if necessary.  RW must not already be held by the current
+   thread.
+
+   This function may sleep, so it must not be called within an
+   interrupt handler. */
+void
+rwlock_acquire_write (struct rwlock *rw)
+{
+  const void *site = __builtin_return_address (0);
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+  ASSERT (rw->writer != thread_current ());
+
+  rw_lock (rw, site);
+  rw->waiting_writers++;
+  while (!may_write (rw))
+    rw_wait (rw, &rw->can_write, site);
+  rw->waiting_writers--;
+  rw->writer = thread_current ();
+  lock_release (&rw->lock);
+}
+
+/** Tries to acquire RW for writing without waiting for other
+   holders.  Returns true if successful, false on failure.
+
+   RW's internal lock is still acquired, so this function must
+   not be called within an interrupt handler. */
+bool
+rwlock_try_acquire_write (struct rwlock *rw)
+{
+  bool success;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  rw_lock (rw, __builtin_return_address (0));
+  success = may_write (rw);
+  if (success)
+    rw->writer = thread_current ();
+  lock_release (&rw->lock);
+  return success;
+}
+
+/** Releases RW, which the current thread must hold for writing.
+   Readers that were waiting are let in first, all at once;
+   otherwise one waiting writer is. */
+void
+rwlock_release_write (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_for_write (rw));
+
+  rw_lock (rw, __builtin_return_address (0));
+  rw->writer = NULL;
+  if (rw->waiting_readers > 0)
+    {
+      rw->read_batch = rw->waiting_readers;
+      cond_broadcast (&rw->can_read, &rw->lock);
+    }
+  else if (rw->waiting_writers > 0)
+    cond_signal (&rw->can_write, &rw->lock);
+  lock_release (&rw->lock);
+}
+
+/** Tries to turn the current thread's read hold on RW into a
+   write hold.  This succeeds only if the current thread is RW's
+   only reader and no reader is about to enter.  Returns true if
+   successful; on failure the current thread still holds RW for
+   reading.  (Waiting for the other readers instead could
+   deadlock if two readers tried to upgrade at once.) */
+bool
+rwlock_try_upgrade (struct rwlock *rw)
+{
+  bool success;
+
+  ASSERT (rw != NULL);
+  ASSERT (!intr_context ());
+
+  rw_lock (rw, __builtin_return_address (0));
+  ASSERT (rw->readers > 0);
+  success = rw->readers == 1 && rw->read_batch == 0;
+  if (success)
+    {
+      rw->readers = 0;
+      rw->writer = thread_current ();
+    }
+  lock_release (&rw->lock);
+  return success;
+}
+
+/** Turns the current thread's write hold on RW into a read hold,
+   without letting a writer in between.  Waiting readers are let
+   in along with it. */
+void
+rwlock_downgrade (struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+  ASSERT (rwlock_held_for_write (rw));
+
+  rw_lock (rw, __builtin_return_address (0));
+  rw->writer = NULL;
+  rw->readers++;
+  if (rw->waiting_readers > 0)
+    {
+      rw->read_batch = rw->waiting_readers;
+      cond_broadcast (&rw->can_read, &rw->lock);
+    }
+  lock_release (&rw->lock);
+}
+
+/** Returns true if the current thread holds RW for writing,
+   false otherwise.  There is no way to ask whether the current
+   thread holds RW for reading, because readers are not
+   tracked individually. */
+bool
+rwlock_held_for_write (const struct rwlock *rw)
+{
+  ASSERT (rw != NULL);
+
+  return rw->writer == thread_current ();
+}
+
+/** Returns true if the thread owning `elem' A_ has a lower
+   priority than the one owning B_. */
+static bool
+priority_less (const struct list_elem *a_, const struct list_elem *b_,
+               void *aux UNUSED) 
+{
+  const struct thread *a = list_entry (a_, struct thread, elem);
+  const struct thread *b = list_entry (b_, struct thread, elem);
+
+  return a->priority < b->priority;
+}
+
+/** Returns true if the thread waiting on condition variable
+   waiter A_ has a lower priority than the one waiting on B_. */
+static bool
+cond_priority_less (const struct list_elem *a_, const struct list_elem *b_,
+                    void *aux UNUSED) 
+{
+  const struct semaphore_elem *a = list_entry (a_, struct semaphore_elem, elem);
+  const struct semaphore_elem *b = list_entry (b_, struct semaphore_elem, elem);
+
+  return a->thread->priority < b->thread->priority;
+}
+
+/** Recomputes the priority of the holder of the lock T is
+   waiting for, after T has started donating to it or has
+   withdrawn its donation.  If the holder is itself waiting for a
+   lock, continues to that lock's holder, and so on, for at most
+   DONATION_DEPTH_MAX locks or until a holder's priority does not
+   change.  Must be called with interrupts off. */
+static void
+donate_priority (struct thread *t) 
+{
+  int depth;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  for (depth = 0; depth < DONATION_DEPTH_MAX && t->waiting_lock != NULL;
+       depth++)
+    {
+      struct thread *holder = t->waiting_lock->holder;
+      if (holder == NULL || !thread_update_priority (holder))
+        break;
+      t = holder;
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <list.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 /** A counting semaphore. */
 struct semaphore 
@@ -13,6 +14,7 @@ struct semaphore
 
 void sema_init (struct semaphore *, unsigned value);
 void sema_down (struct semaphore *);
+bool sema_down_timeout (struct semaphore *, int64_t ticks);
 bool sema_try_down (struct semaphore *);
 void sema_up (struct semaphore *);
 void sema_self_test (void);
@@ -22,10 +24,19 @@ struct lock
   {
     struct thread *holder;      /**< Thread holding lock (for debugging). */
     struct semaphore semaphore; /**< Binary semaphore controlling access. */
+    const char *name;           /**< Name, for the lock profiler. */
+    int prof_site;              /**< Lock profiler site of the holder. */
+    uint64_t prof_acquired;     /**< Time stamp counter when acquired. */
   };
 
-void lock_init (struct lock *);
+void lock_init_named (struct lock *, const char *name);
+
+/** Initializes LOCK, naming it after the expression that was
+   used to refer to it, e.g. "&tid_table_lock". */
+#define lock_init(LOCK) lock_init_named (LOCK, #LOCK)
+
 void lock_acquire (struct lock *);
+bool lock_acquire_timeout (struct lock *, int64_t ticks);
 bool lock_try_acquire (struct lock *);
 void lock_release (struct lock *);
 bool lock_held_by_current_thread (const struct lock *);
@@ -38,9 +49,39 @@ struct condition
 
 void cond_init (struct condition *);
 void cond_wait (struct condition *, struct lock *);
+bool cond_wait_timeout (struct condition *, struct lock *, int64_t ticks);
 void cond_signal (struct condition *, struct lock *);
 void cond_broadcast (struct condition *, struct lock *);
 
+/** Readers-writer lock. */
+struct rwlock
+  {
+    struct lock lock;           /**< Protects the members below. */
+    struct condition can_read;  /**< Signaled when readers may enter. */
+    struct condition can_write; /**< Signaled when a writer may enter. */
+    struct thread *writer;      /**< Thread holding it for writing. */
+    unsigned readers;           /**< Number of threads reading. */
+    unsigned waiting_readers;   /**< Readers waiting to enter. */
+    unsigned waiting_writers;   /**< Writers waiting to enter. */
+    unsigned read_batch;        /**< Readers let in ahead of writers. */
+  };
+
+void rwlock_init_named (struct rwlock *, const char *name);
+
+/** Initializes RW, naming it for the lock profiler after the
+   expression that was used to refer to it, as lock_init() does. */
+#define rwlock_init(RW) rwlock_init_named (RW, #RW)
+
+void rwlock_acquire_read (struct rwlock *);
+bool rwlock_try_acquire_read (struct rwlock *);
+void rwlock_release_read (struct rwlock *);
+void rwlock_acquire_write (struct rwlock *);
+bool rwlock_try_acquire_write (struct rwlock *);
+void rwlock_release_write (struct rwlock *);
+bool rwlock_try_upgrade (struct rwlock *);
+void rwlock_downgrade (struct rwlock *);
+bool rwlock_held_for_write (const struct rwlock *);
+
 /** Optimization barrier.
 
    The compiler will not reorder operations across an
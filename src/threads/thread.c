@@ -2,14 +2,20 @@
 #include <debug.h>
 #include <stddef.h>
 #include <random.h>
+#include <round.h>
 #include <stdio.h>
 #include <string.h>
+#include "devices/timer.h"
+#include "threads/fixed-point.h"
 #include "threads/flags.h"
+#include "threads/init.h"
 #include "threads/interrupt.h"
 #include "threads/intr-stubs.h"
+#include "threads/malloc.h"
 #include "threads/palloc.h"
 #include "threads/switch.h"
 #include "threads/synch.h"
+#include "threads/trace.h"
 #include "threads/vaddr.h"
 #ifdef USERPROG
 #include "userprog/process.h"
@@ -20,14 +26,58 @@
    of thread.h for details. */
 #define THREAD_MAGIC 0xcd6abf4b
 
-/* List of processes in THREAD_READY state, that is, processes
-   that are ready to run but not actually running. */
-static struct list ready_list;
+/* Number of distinct thread priorities. */
+#define PRI_CNT (PRI_MAX - PRI_MIN + 1)
+
+/* Run queues of processes in THREAD_READY state, that is,
+   processes that are ready to run but not actually running.
+   There is one FIFO queue per priority level, indexed by
+   priority. */
+static struct list ready_queues[PRI_CNT];
+
+/* Bit P is set if and only if ready_queues[P] is nonempty, so
+   that the highest nonempty queue can be found without scanning
+   all of them. */
+static uint64_t ready_mask;
+
+/* Under the stride and CFS schedulers, the ready threads instead
+   form a binary min-heap ordered by pass, so that the thread that
+   is furthest behind its share is always at pass_heap[0].  Every
+   thread has a page of its own, so the heap never needs more
+   slots than there are pages of RAM. */
+static struct thread **pass_heap;
+static size_t pass_heap_cnt;
 
 /* List of all processes.  Processes are added to this list
    when they are first scheduled and removed when they exit. */
 static struct list all_list;
 
+/* Live threads, indexed by tid, so that thread_get() need not
+   scan all_list.  Threads are added when created and removed
+   when they exit. */
+static struct hash tid_table;
+
+/* Child elements (see struct child_element), indexed by the
+   child's tid.  An element stays here until its parent frees it,
+   which may be long after the child itself has exited. */
+static struct hash child_table;
+
+/* Protects tid_table and child_table.  Both grow with malloc(),
+   so they are guarded by a lock rather than by disabling
+   interrupts. */
+static struct lock tid_table_lock;
+
+/* Pages of exited threads, kept for reuse by thread_create() so
+   that creating a thread need not take the page allocator's lock
+   or zero a whole page.  Linked through the dead threads'
+   allelem members. */
+#define PAGE_CACHE_MAX 16       /* Most pages to keep. */
+static struct list page_cache;
+static size_t page_cache_cnt;   /* # of pages in page_cache. */
+static long long page_cache_hits;   /* # of creates served from it. */
+static long long page_cache_misses; /* # that went to palloc. */
+bool thread_page_cache = true;
+
 /* Idle thread. */
 static struct thread *idle_thread;
 
@@ -51,14 +101,98 @@ static long long kernel_ticks;  /* # of timer ticks in kernel threads. */
 static long long user_ticks;    /* # of timer ticks in user programs. */
 
 /* Scheduling. */
-#define TIME_SLICE 4            /* # of timer ticks to give each thread. */
-static unsigned thread_ticks;   /* # of timer ticks since last yield. */
+int thread_time_slice = SLICE_DEFAULT; /* Default # of ticks per slice. */
+static int thread_ticks;        /* # of timer ticks since last yield. */
+static long long switch_cnt;    /* # of context switches. */
+
+/* Directed handoff.  A thread that wakes another and then blocks
+   or yields may name it in its handoff member, and schedule()
+   then switches straight to it, ahead of the run queue, as long
+   as that does not jump a thread the policy would prefer.  The
+   woken thread runs on what is left of its waker's time slice,
+   so a pair of threads handing the CPU back and forth still
+   gets preempted on time. */
+bool thread_handoff;
+static bool slice_handed_off;   /* Keep thread_ticks on this switch? */
+static long long handoff_cnt;   /* # of switches by handoff. */
 
 /* If false (default), use round-robin scheduler.
    If true, use multi-level feedback queue scheduler.
    Controlled by kernel command-line option "-o mlfqs". */
 bool thread_mlfqs;
 
+/* Multi-level feedback queue scheduler. */
+#define MLFQS_PRI_TICKS 4       /* # of timer ticks between priority updates. */
+static int load_avg;            /* System load average, in fixed-point. */
+static int ready_cnt;           /* # of threads in the run queues. */
+
+/* Threads whose recent_cpu has changed since their priority was
+   last computed.  Between the once-per-second updates only a
+   running thread's recent_cpu changes, so the periodic priority
+   update only needs to visit the few threads that ran lately
+   rather than all of all_list. */
+static struct list cpu_dirty_list;
+
+/* Scheduling policy in use. */
+enum sched_policy thread_sched;
+
+/* Stride scheduler.  Each tick a thread runs advances its pass
+   by STRIDE1 / tickets, so over time every thread receives CPU
+   in proportion to its tickets.  global_pass is the pass of the
+   thread most recently picked to run; a thread that wakes up
+   after blocking starts there, so that it can neither hoard the
+   time it slept nor be starved for it. */
+#define STRIDE1 (1 << 20)
+static int64_t global_pass;
+
+/* Completely fair scheduler.  Each tick a thread runs advances
+   its pass, here called its virtual runtime, by STRIDE1 scaled
+   by NICE0_WEIGHT / its weight, so a nice 0 thread gains STRIDE1
+   per tick and each step of nice changes the CPU share by about
+   10%.  global_pass follows the least virtual runtime, never
+   moving backward.
+
+   A thread that wakes up is placed no further back than
+   CFS_SLEEPER_CREDIT before global_pass, so that after sleeping
+   it runs ahead of threads that kept the CPU busy, but cannot
+   bank its whole sleep.  A woken thread preempts the running one
+   if it is more than CFS_WAKEUP_GRAN behind it. */
+#define NICE0_WEIGHT 1024
+#define CFS_SLEEPER_CREDIT ((int64_t) thread_time_slice * STRIDE1 / 2)
+#define CFS_WAKEUP_GRAN STRIDE1
+
+/* Weight of each nice value from NICE_MIN to NICE_MAX, about 1.25
+   times less for each step up. */
+static const int cfs_weights[NICE_MAX - NICE_MIN + 1] =
+{
+    88761, 71755, 56483, 46273, 36291,  /* -20 ... -16 */
+    29154, 23254, 18705, 14949, 11916,  /* -15 ... -11 */
+     9548,  7620,  6100,  4904,  3906,  /* -10 ...  -6 */
+     3121,  2501,  1991,  1586,  1277,  /*  -5 ...  -1 */
+     1024,   820,   655,   526,   423,  /*   0 ...   4 */
+      335,   272,   215,   172,   137,  /*   5 ...   9 */
+      110,    87,    70,    56,    45,  /*  10 ...  14 */
+       36,    29,    23,    18,    15,  /*  15 ...  19 */
+       12,                              /*  20 */
+};
+
+/* Real-time class.  Ready real-time threads run before all
+   others, whatever the policy, earliest absolute deadline first.
+   Each declares a period, a runtime budget per period, and a
+   deadline relative to the start of each period, all in timer
+   ticks.  A thread that uses up its budget is held back until
+   its next period, so admitted threads get no more than the CPU
+   bandwidth they declared.  Admission keeps the total density,
+   runtime / deadline, under RT_BW_MAX, which is enough for EDF
+   to meet every deadline and leaves some CPU for the rest. */
+#define RT_BW_ONE 1000000                   /* All of the CPU. */
+#define RT_BW_MAX (RT_BW_ONE / 100 * 95)    /* Most that is admitted. */
+static struct list rt_ready_list;   /* Ready RT threads, by deadline. */
+static long rt_bandwidth;           /* Bandwidth admitted, of RT_BW_ONE. */
+static long long rt_jobs;           /* # of jobs released. */
+static long long rt_misses;         /* # of deadlines missed. */
+static long long rt_rejects;        /* # of admissions refused. */
+
 static void kernel_thread (thread_func *, void *aux);
 
 static void idle (void *aux UNUSED);
@@ -67,9 +201,36 @@ static struct thread *next_thread_to_run (void);
 static void init_thread (struct thread *, const char *name, int priority);
 static bool is_thread (struct thread *) UNUSED;
 static void *alloc_frame (struct thread *, size_t size);
+static struct thread *alloc_thread_page (void);
+static void free_thread_page (struct thread *);
 static void schedule (void);
+static struct thread *take_handoff (struct thread *);
+static void yield (bool voluntary);
+static void ready_push (struct thread *);
+static void ready_remove (struct thread *);
+static int ready_highest (void);
+static void mlfqs_tick (struct thread *);
+static int mlfqs_priority (const struct thread *);
+static void mlfqs_update_priority (struct thread *);
+static void set_effective_priority (struct thread *, int priority);
+static bool pass_sched (void);
+static void print_shares (void);
+static long rt_density (int64_t runtime, int64_t deadline);
+static void rt_release_job (struct thread *, int64_t release);
+static void rt_next_job (struct thread *);
+static void rt_check_deadline (struct thread *, int64_t now);
+static list_less_func rt_deadline_less;
+static void heap_push (struct thread *);
+static void heap_remove (struct thread *);
+static void heap_sift_up (size_t);
+static void heap_sift_down (size_t);
+static void heap_swap (size_t, size_t);
 void thread_schedule_tail (struct thread *prev);
 static tid_t allocate_tid (void);
+static hash_hash_func tid_hash;
+static hash_less_func tid_less;
+static hash_hash_func child_hash;
+static hash_less_func child_less;
 
 struct child_element* create_child(struct thread *t);
 
@@ -89,11 +250,21 @@ struct child_element* create_child(struct thread *t);
 void
 thread_init (void)
 {
+    int i;
+
     ASSERT (intr_get_level () == INTR_OFF);
 
     lock_init (&tid_lock);
-    list_init (&ready_list);
+    lock_init (&tid_table_lock);
+    for (i = 0; i < PRI_CNT; i++)
+        list_init (&ready_queues[i]);
+    ready_mask = 0;
+    ready_cnt = 0;
     list_init (&all_list);
+    list_init (&cpu_dirty_list);
+    list_init (&page_cache);
+    list_init (&rt_ready_list);
+    load_avg = 0;
 
     /* Set up a thread structure for the running thread. */
     initial_thread = running_thread ();
@@ -110,8 +281,24 @@ thread_init (void)
 void
 thread_start (void)
 {
-    /* Create the idle thread. */
     struct semaphore idle_started;
+
+    /* Set up the tid tables, which need malloc() and so could not
+       be initialized in thread_init(). */
+    if (!hash_init (&tid_table, tid_hash, tid_less, NULL)
+            || !hash_init (&child_table, child_hash, child_less, NULL))
+        PANIC ("cannot allocate tid tables");
+    hash_insert (&tid_table, &initial_thread->tidelem);
+
+    /* Set up the pass heap, which is too big to be static. */
+    if (pass_sched ())
+    {
+        size_t page_cnt = DIV_ROUND_UP (init_ram_pages * sizeof *pass_heap,
+                                        PGSIZE);
+        pass_heap = palloc_get_multiple (PAL_ASSERT, page_cnt);
+    }
+
+    /* Create the idle thread. */
     sema_init (&idle_started, 0);
     thread_create ("idle", PRI_MIN, idle, &idle_started);
 
@@ -123,12 +310,19 @@ thread_start (void)
 }
 
 /* Called by the timer interrupt handler at each timer tick.
+   USER is true if the tick interrupted user code.
    Thus, this function runs in an external interrupt context. */
 void
-thread_tick (void)
+thread_tick (bool user)
 {
     struct thread *t = thread_current ();
 
+    /* Update per-thread usage. */
+    if (user)
+        t->usage.user_ticks++;
+    else if (t != idle_thread)
+        t->usage.kernel_ticks++;
+
     /* Update statistics. */
     if (t == idle_thread)
         idle_ticks++;
@@ -139,8 +333,30 @@ thread_tick (void)
     else
         kernel_ticks++;
 
+    trace_record (TRACE_TICK, t);
+
+    /* Charge a real-time thread's budget, and hold it back until
+       its next period once the budget is gone. */
+    if (t->rt)
+    {
+        rt_check_deadline (t, timer_ticks ());
+        if (--t->rt_budget <= 0)
+        {
+            t->rt_throttled = true;
+            intr_yield_on_return ();
+        }
+    }
+
+    if (thread_mlfqs)
+        mlfqs_tick (t);
+    else if (thread_sched == SCHED_STRIDE && t != idle_thread)
+        t->pass += STRIDE1 / t->tickets;
+    else if (thread_sched == SCHED_CFS && t != idle_thread)
+        t->pass += (int64_t) STRIDE1 * NICE0_WEIGHT
+                   / cfs_weights[t->nice - NICE_MIN];
+
     /* Enforce preemption. */
-    if (++thread_ticks >= TIME_SLICE)
+    if (++thread_ticks >= (t->quantum > 0 ? t->quantum : thread_time_slice))
         intr_yield_on_return ();
 }
 
@@ -150,6 +366,70 @@ thread_print_stats (void)
 {
     printf ("Thread: %lld idle ticks, %lld kernel ticks, %lld user ticks\n",
             idle_ticks, kernel_ticks, user_ticks);
+    if (timer_tickless)
+        printf ("Thread: %lld ticks elided by tickless idle\n",
+                (long long) timer_elided_ticks ());
+    printf ("Thread: %lld pages recycled, %lld allocated\n",
+            page_cache_hits, page_cache_misses);
+    printf ("Thread: %lld handoffs\n", handoff_cnt);
+    printf ("Thread: %lld context switches, %lld per second, "
+            "%d ticks per slice at %d Hz\n",
+            switch_cnt, switch_cnt * TIMER_FREQ / (timer_ticks () + 1),
+            thread_time_slice, TIMER_FREQ);
+    if (pass_sched ())
+        print_shares ();
+    if (rt_jobs > 0 || rt_rejects > 0)
+        printf ("Thread: %lld real-time jobs, %lld deadlines missed, "
+                "%lld admissions refused\n", rt_jobs, rt_misses, rt_rejects);
+}
+
+/* Prints, for each live thread, its share of the tickets (under
+   CFS, of the weight) held by all live threads next to the share
+   of their CPU time that it actually received. */
+static void
+print_shares (void)
+{
+    enum { SHARES_MAX = 32 };
+    static struct
+    {
+        tid_t tid;
+        char name[16];
+        int tickets;
+        int64_t ticks;
+    } shares[SHARES_MAX];
+    const char *unit = thread_sched == SCHED_CFS ? "weight" : "tickets";
+    long long total_tickets = 0, total_ticks = 0;
+    enum intr_level old_level;
+    struct list_elem *e;
+    int cnt = 0;
+    int i;
+
+    /* Take a snapshot, because printf() may sleep. */
+    old_level = intr_disable ();
+    for (e = list_begin (&all_list);
+            e != list_end (&all_list) && cnt < SHARES_MAX; e = list_next (e))
+    {
+        struct thread *t = list_entry (e, struct thread, allelem);
+        if (t == idle_thread)
+            continue;
+        shares[cnt].tid = t->tid;
+        strlcpy (shares[cnt].name, t->name, sizeof shares[cnt].name);
+        shares[cnt].tickets = (thread_sched == SCHED_CFS
+                               ? cfs_weights[t->nice - NICE_MIN]
+                               : t->tickets);
+        shares[cnt].ticks = t->usage.user_ticks + t->usage.kernel_ticks;
+        total_tickets += shares[cnt].tickets;
+        total_ticks += shares[cnt].ticks;
+        cnt++;
+    }
+    intr_set_level (old_level);
+
+    for (i = 0; i < cnt; i++)
+        printf ("Thread: tid %d (%s): %d %s, "
+                "%lld%% of %s, %lld%% of CPU\n",
+                shares[i].tid, shares[i].name, shares[i].tickets, unit,
+                shares[i].tickets * 100 / total_tickets, unit,
+                total_ticks > 0 ? shares[i].ticks * 100 / total_ticks : 0);
 }
 
 /* Creates a new kernel thread named NAME with the given initial
@@ -164,9 +444,9 @@ thread_print_stats (void)
    scheduled.  Use a semaphore or some other form of
    synchronization if you need to ensure ordering.
 
-   The code provided sets the new thread's `priority' member to
-   PRIORITY, but no actual priority scheduling is implemented.
-   Priority scheduling is the goal of Problem 1-3. */
+   If the new thread has a higher priority than the running
+   thread, the running thread yields to it before this function
+   returns. */
 tid_t
 thread_create (const char *name, int priority,
                thread_func *function, void *aux)
@@ -181,7 +461,7 @@ thread_create (const char *name, int priority,
     ASSERT (function != NULL);
 
     /* Allocate thread. */
-    t = palloc_get_page (PAL_ZERO);
+    t = alloc_thread_page ();
     if (t == NULL)
         return TID_ERROR;
 
@@ -194,6 +474,11 @@ thread_create (const char *name, int priority,
     list_push_back(&thread_current()->child_list, &child->child_elem);
     t->parent = thread_current();
 
+    lock_acquire (&tid_table_lock);
+    hash_insert (&tid_table, &t->tidelem);
+    hash_insert (&child_table, &child->pid_elem);
+    lock_release (&tid_table_lock);
+
     old_level = intr_disable ();
 
     /* Stack frame for kernel_thread(). */
@@ -215,6 +500,7 @@ thread_create (const char *name, int priority,
 
     /* Add to run queue. */
     thread_unblock (t);
+    thread_check_preempt ();
 
     return tid;
 }
@@ -228,11 +514,14 @@ create_child(struct thread *t)
 {
     struct child_element* child = malloc(sizeof(struct child_element));
     child -> child_pid = t->tid;
+    child -> parent_tid = thread_tid();
     child -> first_time = true;
     child -> loaded_success = false;
-    child -> real_child = t;
+    sema_init(&child -> sema_exec, 0);
+    sema_init(&child -> sema_wait, 0);
     child -> exit_status = INIT_STATUS;
     child -> cur_status = STILL_ALIVE;
+    return child;
 }
 
 /* Searches for the thread with tid  = TID and
@@ -240,22 +529,74 @@ create_child(struct thread *t)
 struct thread *
 thread_get (tid_t tid)
 {
-    struct list_elem *e;
-    enum intr_level old_level;
+    struct thread key;
+    struct hash_elem *e;
 
-    old_level = intr_disable ();
+    key.tid = tid;
+    lock_acquire (&tid_table_lock);
+    e = hash_find (&tid_table, &key.tidelem);
+    lock_release (&tid_table_lock);
 
-    for (e = list_begin (&all_list); e != list_end (&all_list);
-            e = list_next (e))
+    return e != NULL ? hash_entry (e, struct thread, tidelem) : NULL;
+}
+
+/* Returns the child element for the thread with tid TID, or a
+   null pointer if there is none, either because TID was never
+   created or because its parent has already freed it.  Callers
+   looking up one of their own children must still check
+   parent_tid. */
+struct child_element *
+thread_get_child (tid_t tid)
+{
+    struct child_element key;
+    struct hash_elem *e;
+
+    key.child_pid = tid;
+    lock_acquire (&tid_table_lock);
+    e = hash_find (&child_table, &key.pid_elem);
+    lock_release (&tid_table_lock);
+
+    return e != NULL ? hash_entry (e, struct child_element, pid_elem) : NULL;
+}
+
+/* Like thread_get_child(), but if the element is found, returns
+   with the child table locked, so that the parent cannot remove
+   and free the element until thread_unlock_child() is called.
+   A child uses this to store into its own element.  Returns a
+   null pointer, without the lock held, if there is no element. */
+struct child_element *
+thread_lock_child (tid_t tid)
+{
+    struct child_element key;
+    struct hash_elem *e;
+
+    key.child_pid = tid;
+    lock_acquire (&tid_table_lock);
+    e = hash_find (&child_table, &key.pid_elem);
+    if (e == NULL)
     {
-        struct thread *t = list_entry (e, struct thread, allelem);
-        if (t->tid == tid)
-            return t;
+        lock_release (&tid_table_lock);
+        return NULL;
     }
+    return hash_entry (e, struct child_element, pid_elem);
+}
 
-    intr_set_level (old_level);
+/* Unlocks the child table locked by thread_lock_child(). */
+void
+thread_unlock_child (void)
+{
+    lock_release (&tid_table_lock);
+}
 
-    return NULL;
+/* Removes CHILD from the child table, so that it can be freed.
+   Once this returns, no thread can be using CHILD through
+   thread_lock_child(). */
+void
+thread_remove_child (struct child_element *child)
+{
+    lock_acquire (&tid_table_lock);
+    hash_delete (&child_table, &child->pid_elem);
+    lock_release (&tid_table_lock);
 }
 
 /* Puts the current thread to sleep.  It will not be scheduled
@@ -270,6 +611,8 @@ thread_block (void)
     ASSERT (!intr_context ());
     ASSERT (intr_get_level () == INTR_OFF);
 
+    thread_current ()->usage.voluntary_switches++;
+    trace_record (TRACE_BLOCK, thread_current ());
     thread_current ()->status = THREAD_BLOCKED;
     schedule ();
 }
@@ -281,7 +624,8 @@ thread_block (void)
    This function does not preempt the running thread.  This can
    be important: if the caller had disabled interrupts itself,
    it may expect that it can atomically unblock a thread and
-   update other data. */
+   update other data.  Call thread_check_preempt() afterward to
+   give the CPU to T if it has a higher priority. */
 void
 thread_unblock (struct thread *t)
 {
@@ -291,7 +635,15 @@ thread_unblock (struct thread *t)
 
     old_level = intr_disable ();
     ASSERT (t->status == THREAD_BLOCKED);
-    list_push_back (&ready_list, &t->elem);
+    trace_record (TRACE_UNBLOCK, t);
+    if (thread_sched == SCHED_CFS)
+    {
+        if (t->pass < global_pass - CFS_SLEEPER_CREDIT)
+            t->pass = global_pass - CFS_SLEEPER_CREDIT;
+    }
+    else if (t->pass < global_pass)
+        t->pass = global_pass;
+    ready_push (t);
     t->status = THREAD_READY;
     intr_set_level (old_level);
 }
@@ -340,11 +692,20 @@ thread_exit (void)
     process_exit ();
 #endif
 
+    lock_acquire (&tid_table_lock);
+    hash_delete (&tid_table, &thread_current ()->tidelem);
+    lock_release (&tid_table_lock);
+
     /* Remove thread from all threads list, set our status to dying,
        and schedule another process.  That process will destroy us
        when it calls thread_schedule_tail(). */
     intr_disable ();
+    if (thread_current ()->rt)
+        rt_bandwidth -= rt_density (thread_current ()->rt_runtime,
+                                    thread_current ()->rt_deadline);
     list_remove (&thread_current()->allelem);
+    if (thread_current ()->cpu_dirty)
+        list_remove (&thread_current ()->cpu_elem);
     thread_current ()->status = THREAD_DYING;
     schedule ();
     NOT_REACHED ();
@@ -354,6 +715,64 @@ thread_exit (void)
    may be scheduled again immediately at the scheduler's whim. */
 void
 thread_yield (void)
+{
+    yield (true);
+}
+
+/* Yields the CPU to ready thread T, which runs next on the rest
+   of the current thread's time slice unless a thread the
+   scheduler prefers to T is ready, in which case this is the same
+   as thread_yield(). */
+void
+thread_yield_to (struct thread *t)
+{
+    enum intr_level old_level;
+
+    ASSERT (is_thread (t));
+
+    old_level = intr_disable ();
+    thread_current ()->handoff = t;
+    yield (true);
+    intr_set_level (old_level);
+}
+
+/* Records that the running thread has just made T ready, so
+   that if thread_handoff is on, T runs as soon as the running
+   thread blocks or yields.  Does nothing in an interrupt
+   handler, which is not running on behalf of the thread it
+   interrupted. */
+void
+thread_hint_handoff (struct thread *t)
+{
+    if (thread_handoff && !intr_context ())
+        running_thread ()->handoff = t;
+}
+
+/* Like thread_yield(), but on behalf of the scheduler rather
+   than the running thread, because its time slice expired or a
+   higher-priority thread became ready.  Counts as an involuntary
+   context switch.  A real-time thread that has used up its
+   budget instead sleeps until its next period. */
+void
+thread_preempt (void)
+{
+    struct thread *cur = thread_current ();
+    enum intr_level old_level;
+
+    if (cur->rt && cur->rt_throttled)
+    {
+        old_level = intr_disable ();
+        rt_next_job (cur);
+        intr_set_level (old_level);
+    }
+    else
+        yield (false);
+}
+
+/* Puts the running thread back on the run queue and schedules,
+   counting the switch as VOLUNTARY or not. */
+static void
+yield (bool voluntary)
 {
     struct thread *cur = thread_current ();
     enum intr_level old_level;
@@ -361,13 +780,61 @@ thread_yield (void)
     ASSERT (!intr_context ());
 
     old_level = intr_disable ();
+    if (voluntary)
+        cur->usage.voluntary_switches++;
+    else
+    {
+        /* The slice is used up, so there is none to hand off. */
+        cur->handoff = NULL;
+        cur->usage.involuntary_switches++;
+    }
+    trace_record (TRACE_YIELD, cur);
     if (cur != idle_thread)
-        list_push_back (&ready_list, &cur->elem);
+        ready_push (cur);
     cur->status = THREAD_READY;
     schedule ();
     intr_set_level (old_level);
 }
 
+/* Yields the CPU if a ready thread has a higher priority than
+   the running thread.  In an interrupt handler, the yield is
+   deferred until the handler returns. */
+void
+thread_check_preempt (void)
+{
+    struct thread *cur = running_thread ();
+    enum intr_level old_level;
+    bool preempt;
+
+    old_level = intr_disable ();
+    if (!list_empty (&rt_ready_list))
+        preempt = !cur->rt || rt_deadline_less (list_front (&rt_ready_list),
+                                                &cur->elem, NULL);
+    else if (cur->rt)
+        preempt = false;
+    else if (thread_sched == SCHED_STRIDE)
+        preempt = pass_heap_cnt > 0 && cur == idle_thread;
+    else if (thread_sched == SCHED_CFS)
+        preempt = pass_heap_cnt > 0
+                  && (cur == idle_thread
+                      || pass_heap[0]->pass + CFS_WAKEUP_GRAN < cur->pass);
+    else
+        preempt = ready_mask != 0
+                  && (cur == idle_thread || ready_highest () > cur->priority);
+    if (preempt)
+    {
+        if (intr_context ())
+            intr_yield_on_return ();
+        else
+        {
+            intr_set_level (old_level);
+            thread_preempt ();
+            return;
+        }
+    }
+    intr_set_level (old_level);
+}
+
 /* Invoke function 'func' on all threads, passing along 'aux'.
    This function must be called with interrupts off. */
 void
@@ -385,49 +852,405 @@ thread_foreach (thread_action_func *func, void *aux)
     }
 }
 
-/* Sets the current thread's priority to NEW_PRIORITY. */
+/* Sets the current thread's base priority to NEW_PRIORITY and
+   yields if that leaves a ready thread with a higher priority.
+   Donations received through locks the thread holds still apply.
+   Has no effect under the MLFQS, which computes priorities
+   itself. */
 void
 thread_set_priority (int new_priority)
 {
-    thread_current ()->priority = new_priority;
+    struct thread *cur = thread_current ();
+    enum intr_level old_level;
+
+    ASSERT (PRI_MIN <= new_priority && new_priority <= PRI_MAX);
+
+    if (thread_mlfqs)
+        return;
+
+    old_level = intr_disable ();
+    cur->base_priority = new_priority;
+    thread_update_priority (cur);
+    intr_set_level (old_level);
+    thread_check_preempt ();
 }
 
-/* Returns the current thread's priority. */
+/* Recomputes T's effective priority as the maximum of its base
+   priority and the priorities of the threads donating to it,
+   moving T to the matching run queue if it is ready.  Returns
+   true if the effective priority changed.  Must be called with
+   interrupts off. */
+bool
+thread_update_priority (struct thread *t)
+{
+    int priority = t->base_priority;
+    struct list_elem *e;
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    for (e = list_begin (&t->donors); e != list_end (&t->donors);
+            e = list_next (e))
+    {
+        struct thread *donor = list_entry (e, struct thread, donor_elem);
+        if (donor->priority > priority)
+            priority = donor->priority;
+    }
+
+    if (priority == t->priority)
+        return false;
+    set_effective_priority (t, priority);
+    return true;
+}
+
+/* Returns the current thread's effective priority. */
 int
 thread_get_priority (void)
 {
     return thread_current ()->priority;
 }
 
-/* Sets the current thread's nice value to NICE. */
+/* Sets the current thread's nice value to NICE, recomputes its
+   priority, and yields if it no longer has the highest
+   priority.  Under CFS, NICE sets the thread's weight instead,
+   from the next tick on. */
 void
-thread_set_nice (int nice UNUSED)
+thread_set_nice (int nice)
 {
-    /* Not yet implemented. */
+    struct thread *cur = thread_current ();
+    enum intr_level old_level;
+
+    ASSERT (NICE_MIN <= nice && nice <= NICE_MAX);
+
+    old_level = intr_disable ();
+    cur->nice = nice;
+    if (thread_mlfqs)
+        mlfqs_update_priority (cur);
+    intr_set_level (old_level);
+    thread_check_preempt ();
 }
 
 /* Returns the current thread's nice value. */
 int
 thread_get_nice (void)
 {
-    /* Not yet implemented. */
-    return 0;
+    return thread_current ()->nice;
 }
 
 /* Returns 100 times the system load average. */
 int
 thread_get_load_avg (void)
 {
-    /* Not yet implemented. */
-    return 0;
+    enum intr_level old_level = intr_disable ();
+    int ret = round_nearest (multiply_int (load_avg, 100));
+    intr_set_level (old_level);
+    return ret;
 }
 
 /* Returns 100 times the current thread's recent_cpu value. */
 int
 thread_get_recent_cpu (void)
 {
-    /* Not yet implemented. */
-    return 0;
+    enum intr_level old_level = intr_disable ();
+    int ret = round_nearest (multiply_int (thread_current ()->recent_cpu, 100));
+    intr_set_level (old_level);
+    return ret;
+}
+
+/* Sets the current thread's ticket count to TICKETS.  Under the
+   stride scheduler this takes effect from the next tick on. */
+void
+thread_set_tickets (int tickets)
+{
+    ASSERT (TICKETS_MIN <= tickets && tickets <= TICKETS_MAX);
+
+    thread_current ()->tickets = tickets;
+}
+
+/* Returns the current thread's ticket count. */
+int
+thread_get_tickets (void)
+{
+    return thread_current ()->tickets;
+}
+
+/* Sets the current thread's time slice to QUANTUM timer ticks,
+   or back to thread_time_slice if QUANTUM is 0.  Takes effect
+   from the current slice on. */
+void
+thread_set_quantum (int quantum)
+{
+    ASSERT (0 <= quantum && quantum <= SLICE_MAX);
+
+    thread_current ()->quantum = quantum;
+}
+
+/* Returns the current thread's time slice, in timer ticks. */
+int
+thread_get_quantum (void)
+{
+    struct thread *cur = thread_current ();
+
+    return cur->quantum > 0 ? cur->quantum : thread_time_slice;
+}
+
+/* Puts the current thread in the real-time class, with a job
+   released every PERIOD ticks that needs at most RUNTIME ticks
+   of CPU and must finish within DEADLINE ticks of its release.
+   The first job is released at once.  Returns false, leaving
+   the thread's class unchanged, if the parameters are invalid or
+   admitting the thread would overload the CPU.  A real-time
+   thread may call this again to change its parameters. */
+bool
+thread_rt_set (int64_t period, int64_t runtime, int64_t deadline)
+{
+    struct thread *cur = thread_current ();
+    int64_t now = timer_ticks ();
+    enum intr_level old_level;
+    long bandwidth;
+
+    ASSERT (!intr_context ());
+
+    if (runtime <= 0 || runtime > deadline || deadline > period)
+        return false;
+
+    old_level = intr_disable ();
+    bandwidth = rt_bandwidth + rt_density (runtime, deadline);
+    if (cur->rt)
+        bandwidth -= rt_density (cur->rt_runtime, cur->rt_deadline);
+    if (bandwidth > RT_BW_MAX)
+    {
+        rt_rejects++;
+        intr_set_level (old_level);
+        return false;
+    }
+    rt_bandwidth = bandwidth;
+    cur->rt = true;
+    cur->rt_period = period;
+    cur->rt_runtime = runtime;
+    cur->rt_deadline = deadline;
+    rt_release_job (cur, now);
+    intr_set_level (old_level);
+
+    thread_check_preempt ();
+    return true;
+}
+
+/* Returns the current thread to the normal scheduling class. */
+void
+thread_rt_clear (void)
+{
+    struct thread *cur = thread_current ();
+    enum intr_level old_level;
+
+    old_level = intr_disable ();
+    if (cur->rt)
+    {
+        rt_bandwidth -= rt_density (cur->rt_runtime, cur->rt_deadline);
+        cur->rt = false;
+        cur->rt_throttled = false;
+    }
+    intr_set_level (old_level);
+    thread_check_preempt ();
+}
+
+/* Ends the current real-time thread's job and sleeps until the
+   next one is released. */
+void
+thread_rt_wait (void)
+{
+    struct thread *cur = thread_current ();
+    enum intr_level old_level;
+
+    ASSERT (cur->rt);
+
+    old_level = intr_disable ();
+    rt_check_deadline (cur, timer_ticks ());
+    rt_next_job (cur);
+    intr_set_level (old_level);
+}
+
+/* Returns the number of deadlines the current thread has
+   missed. */
+long long
+thread_rt_get_misses (void)
+{
+    return thread_current ()->rt_misses;
+}
+
+/* Returns the density of a task that needs RUNTIME ticks within
+   DEADLINE ticks, as a fraction of RT_BW_ONE, rounded up. */
+static long
+rt_density (int64_t runtime, int64_t deadline)
+{
+    return DIV_ROUND_UP (runtime * RT_BW_ONE, deadline);
+}
+
+/* Starts a new job for real-time thread T, released at tick
+   RELEASE. */
+static void
+rt_release_job (struct thread *t, int64_t release)
+{
+    t->rt_release = release;
+    t->rt_abs_deadline = release + t->rt_deadline;
+    t->rt_budget = t->rt_runtime;
+    t->rt_throttled = false;
+    t->rt_missed = false;
+    rt_jobs++;
+}
+
+/* Blocks real-time thread T, which must be running, until its
+   next period and releases the job for that period.  Must be
+   called with interrupts off. */
+static void
+rt_next_job (struct thread *t)
+{
+    int64_t release = t->rt_release + t->rt_period;
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    timer_block_until (release);
+    rt_release_job (t, release);
+}
+
+/* Counts a miss if real-time thread T's job is not finished at
+   tick NOW and its deadline has passed, once per job. */
+static void
+rt_check_deadline (struct thread *t, int64_t now)
+{
+    if (!t->rt_missed && now > t->rt_abs_deadline)
+    {
+        t->rt_missed = true;
+        t->rt_misses++;
+        rt_misses++;
+    }
+}
+
+/* Orders threads A and B, given by their elem members, by the
+   absolute deadline of their current jobs. */
+static bool
+rt_deadline_less (const struct list_elem *a, const struct list_elem *b,
+                  void *aux UNUSED)
+{
+    return (list_entry (a, struct thread, elem)->rt_abs_deadline
+            < list_entry (b, struct thread, elem)->rt_abs_deadline);
+}
+
+/* Updates the MLFQS statistics for a timer tick during which T
+   was running.  Runs in external interrupt context.
+
+   Every tick charges T one tick of recent_cpu.  Every
+   MLFQS_PRI_TICKS ticks, priorities are recomputed, but only for
+   the threads on cpu_dirty_list.  Once per second, the load
+   average is updated and a single pass over all_list decays
+   every thread's recent_cpu and recomputes its priority. */
+static void
+mlfqs_tick (struct thread *t)
+{
+    int64_t now = timer_ticks ();
+    struct list_elem *e;
+
+    if (t != idle_thread)
+    {
+        t->recent_cpu = add_int (t->recent_cpu, 1);
+        if (!t->cpu_dirty)
+        {
+            t->cpu_dirty = true;
+            list_push_back (&cpu_dirty_list, &t->cpu_elem);
+        }
+    }
+
+    if (now % TIMER_FREQ == 0)
+    {
+        int ready = ready_cnt + (t != idle_thread ? 1 : 0);
+        int twice_load;
+        int decay;
+
+        /* load_avg = (59/60) * load_avg + (1/60) * ready. */
+        load_avg = divide_int (add_int (multiply_int (load_avg, 59), ready), 60);
+
+        /* decay = (2 * load_avg) / (2 * load_avg + 1), computed
+           once for all threads. */
+        twice_load = multiply_int (load_avg, 2);
+        decay = divide_fixed (twice_load, add_int (twice_load, 1));
+
+        for (e = list_begin (&all_list); e != list_end (&all_list);
+                e = list_next (e))
+        {
+            struct thread *u = list_entry (e, struct thread, allelem);
+            if (u == idle_thread)
+                continue;
+            u->recent_cpu = add_int (multiply_fixed (decay, u->recent_cpu),
+                                     u->nice);
+            mlfqs_update_priority (u);
+        }
+
+        while (!list_empty (&cpu_dirty_list))
+            list_entry (list_pop_front (&cpu_dirty_list),
+                        struct thread, cpu_elem)->cpu_dirty = false;
+    }
+    else if (now % MLFQS_PRI_TICKS == 0)
+    {
+        while (!list_empty (&cpu_dirty_list))
+        {
+            struct thread *u = list_entry (list_pop_front (&cpu_dirty_list),
+                                           struct thread, cpu_elem);
+            u->cpu_dirty = false;
+            mlfqs_update_priority (u);
+        }
+    }
+    else
+        return;
+
+    thread_check_preempt ();
+}
+
+/* Returns the MLFQS priority of T,
+   PRI_MAX - (recent_cpu / 4) - (nice * 2), clamped to the valid
+   range. */
+static int
+mlfqs_priority (const struct thread *t)
+{
+    int priority = PRI_MAX - round_down (divide_int (t->recent_cpu, 4))
+                   - t->nice * 2;
+
+    if (priority < PRI_MIN)
+        return PRI_MIN;
+    else if (priority > PRI_MAX)
+        return PRI_MAX;
+    else
+        return priority;
+}
+
+/* Recomputes T's MLFQS priority, moving T to the matching run
+   queue if it is ready.  Must be called with interrupts off. */
+static void
+mlfqs_update_priority (struct thread *t)
+{
+    int priority = mlfqs_priority (t);
+
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    if (priority != t->priority)
+        set_effective_priority (t, priority);
+}
+
+/* Sets T's effective priority to PRIORITY.  If T is ready, moves
+   it to the back of the run queue for its new priority.  Must be
+   called with interrupts off. */
+static void
+set_effective_priority (struct thread *t, int priority)
+{
+    ASSERT (intr_get_level () == INTR_OFF);
+    ASSERT (PRI_MIN <= priority && priority <= PRI_MAX);
+
+    if (t->status == THREAD_READY)
+    {
+        ready_remove (t);
+        t->priority = priority;
+        ready_push (t);
+    }
+    else
+        t->priority = priority;
 }
 
 /* Idle thread.  Executes when no other thread is ready to run.
@@ -437,8 +1260,8 @@ thread_get_recent_cpu (void)
    point it initializes idle_thread, "up"s the semaphore passed
    to it to enable thread_start() to continue, and immediately
    blocks.  After that, the idle thread never appears in the
-   ready list.  It is returned by next_thread_to_run() as a
-   special case when the ready list is empty. */
+   run queues.  It is returned by next_thread_to_run() as a
+   special case when the run queues are empty. */
 static void
 idle (void *idle_started_ UNUSED)
 {
@@ -452,6 +1275,9 @@ idle (void *idle_started_ UNUSED)
         intr_disable ();
         thread_block ();
 
+        /* Stop the periodic tick, in tickless mode. */
+        timer_idle_enter ();
+
         /* Re-enable interrupts and wait for the next one.
 
            The `sti' instruction disables interrupts until the
@@ -515,22 +1341,85 @@ init_thread (struct thread *t, const char *name, int priority)
     t->stack = (uint8_t *) t + PGSIZE;
     t->priority = priority;
 
+    /* Under the MLFQS, a new thread inherits its creator's nice
+       and recent_cpu and ignores PRIORITY. */
+    t->nice = NICE_DEFAULT;
+    t->recent_cpu = 0;
+    if (thread_mlfqs)
+    {
+        if (t != running_thread ())
+        {
+            t->nice = running_thread ()->nice;
+            t->recent_cpu = running_thread ()->recent_cpu;
+        }
+        t->priority = mlfqs_priority (t);
+    }
+    if (thread_sched == SCHED_CFS && t != running_thread ())
+        t->nice = running_thread ()->nice;
+    t->base_priority = t->priority;
+    t->tickets = TICKETS_DEFAULT;
+    t->pass = global_pass;
+    timer_setup (&t->timeout_timer);
+    list_init (&t->donors);
+    t->waiting_lock = NULL;
+
 
 
-    /*init file descriptors list */
-    list_init(&t->fd_list);
-    /*note that 0 1 is not faild so start from 2*/
-    t->fd_size = 1;
+    /*la tabla de descriptores vacia es toda ceros, ya lo esta*/
     t->exec_file = NULL;
     list_init(&t->child_list);
-    sema_init(&t->sema_exec, 0);
-    sema_init(&t->sema_wait, 0);
     t->parent = NULL;
 
     t->magic = THREAD_MAGIC;
     list_push_back (&all_list, &t->allelem);
 }
 
+/* Returns a page for a new thread, from the page cache if it
+   has one and otherwise from the page allocator, or a null
+   pointer if memory is exhausted.  Only the struct thread at
+   the bottom of the page is guaranteed to be zeroed, by
+   init_thread(). */
+static struct thread *
+alloc_thread_page (void)
+{
+    struct thread *t = NULL;
+    enum intr_level old_level;
+
+    old_level = intr_disable ();
+    if (thread_page_cache && !list_empty (&page_cache))
+    {
+        t = list_entry (list_pop_front (&page_cache), struct thread, allelem);
+        page_cache_cnt--;
+        page_cache_hits++;
+    }
+    intr_set_level (old_level);
+
+    if (t == NULL)
+    {
+        t = palloc_get_page (0);
+        if (t != NULL)
+            page_cache_misses++;
+    }
+    return t;
+}
+
+/* Frees the page of dead thread T, keeping it in the page cache
+   if there is room.  Called with interrupts off. */
+static void
+free_thread_page (struct thread *t)
+{
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    t->magic = 0;
+    if (thread_page_cache && page_cache_cnt < PAGE_CACHE_MAX)
+    {
+        list_push_front (&page_cache, &t->allelem);
+        page_cache_cnt++;
+    }
+    else
+        palloc_free_page (t);
+}
+
 /* Allocates a SIZE-byte frame at the top of thread T's stack and
    returns a pointer to the frame's base. */
 static void *
@@ -544,18 +1433,199 @@ alloc_frame (struct thread *t, size_t size)
     return t->stack;
 }
 
+/* Appends T to the run queue for its priority, or under the
+   stride and CFS schedulers adds it to the heap.  Real-time
+   threads go on rt_ready_list, behind those with the same
+   deadline. */
+static void
+ready_push (struct thread *t)
+{
+    ASSERT (intr_get_level () == INTR_OFF);
+
+    if (t->rt)
+    {
+        list_insert_ordered (&rt_ready_list, &t->elem, rt_deadline_less,
+                             NULL);
+        ready_cnt++;
+        return;
+    }
+    if (pass_sched ())
+    {
+        heap_push (t);
+        return;
+    }
+    list_push_back (&ready_queues[t->priority], &t->elem);
+    ready_mask |= (uint64_t) 1 << t->priority;
+    ready_cnt++;
+}
+
+/* Removes ready thread T from its run queue. */
+static void
+ready_remove (struct thread *t)
+{
+    ASSERT (intr_get_level () == INTR_OFF);
+    ASSERT (t->status == THREAD_READY);
+
+    if (t->rt)
+    {
+        list_remove (&t->elem);
+        ready_cnt--;
+        return;
+    }
+    if (pass_sched ())
+    {
+        heap_remove (t);
+        return;
+    }
+    list_remove (&t->elem);
+    if (list_empty (&ready_queues[t->priority]))
+        ready_mask &= ~((uint64_t) 1 << t->priority);
+    ready_cnt--;
+}
+
+/* Returns the highest priority that has a ready thread, or -1 if
+   the run queues are empty.  Must be called with interrupts
+   off. */
+static int
+ready_highest (void)
+{
+    uint32_t high = ready_mask >> 32;
+    uint32_t low = ready_mask;
+
+    if (high != 0)
+        return 63 - __builtin_clz (high);
+    else if (low != 0)
+        return 31 - __builtin_clz (low);
+    else
+        return -1;
+}
+
 /* Chooses and returns the next thread to be scheduled.  Should
    return a thread from the run queue, unless the run queue is
    empty.  (If the running thread can continue running, then it
    will be in the run queue.)  If the run queue is empty, return
-   idle_thread. */
+   idle_thread.
+
+   Picks the front of the highest-priority nonempty queue, which
+   is a find-first-set on ready_mask plus a list unlink.  Under
+   the stride and CFS schedulers, picks the thread with the
+   lowest pass instead.  Either way, a ready real-time thread
+   comes first. */
 static struct thread *
 next_thread_to_run (void)
 {
-    if (list_empty (&ready_list))
+    int pri = ready_highest ();
+    struct list *queue;
+    struct thread *t;
+
+    if (!list_empty (&rt_ready_list))
+    {
+        ready_cnt--;
+        return list_entry (list_pop_front (&rt_ready_list),
+                           struct thread, elem);
+    }
+    if (pass_sched ())
+    {
+        if (pass_heap_cnt == 0)
+            return idle_thread;
+        t = pass_heap[0];
+        heap_remove (t);
+        if (thread_sched == SCHED_STRIDE || t->pass > global_pass)
+            global_pass = t->pass;
+        return t;
+    }
+    if (pri < 0)
         return idle_thread;
-    else
-        return list_entry (list_pop_front (&ready_list), struct thread, elem);
+
+    queue = &ready_queues[pri];
+    t = list_entry (list_pop_front (queue), struct thread, elem);
+    if (list_empty (queue))
+        ready_mask &= ~((uint64_t) 1 << pri);
+    ready_cnt--;
+    return t;
+}
+
+/* Returns true if ready threads are kept in the pass heap rather
+   than in the priority run queues. */
+static bool
+pass_sched (void)
+{
+    return thread_sched == SCHED_STRIDE || thread_sched == SCHED_CFS;
+}
+
+/* Adds ready thread T to the pass heap. */
+static void
+heap_push (struct thread *t)
+{
+    ASSERT (pass_heap_cnt < init_ram_pages);
+
+    t->heap_idx = pass_heap_cnt++;
+    pass_heap[t->heap_idx] = t;
+    heap_sift_up (t->heap_idx);
+    ready_cnt++;
+}
+
+/* Removes ready thread T from the pass heap. */
+static void
+heap_remove (struct thread *t)
+{
+    size_t i = t->heap_idx;
+
+    ASSERT (i < pass_heap_cnt && pass_heap[i] == t);
+
+    if (i != --pass_heap_cnt)
+    {
+        heap_swap (i, pass_heap_cnt);
+        heap_sift_up (i);
+        heap_sift_down (i);
+    }
+    ready_cnt--;
+}
+
+/* Moves the thread at index I of the pass heap toward the
+   root until its parent's pass is no greater than its own. */
+static void
+heap_sift_up (size_t i)
+{
+    while (i > 0 && pass_heap[i]->pass < pass_heap[(i - 1) / 2]->pass)
+    {
+        heap_swap (i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+/* Moves the thread at index I of the pass heap toward the
+   leaves until neither child's pass is less than its own. */
+static void
+heap_sift_down (size_t i)
+{
+    for (;;)
+    {
+        size_t left = 2 * i + 1, right = left + 1, min = i;
+
+        if (left < pass_heap_cnt
+                && pass_heap[left]->pass < pass_heap[min]->pass)
+            min = left;
+        if (right < pass_heap_cnt
+                && pass_heap[right]->pass < pass_heap[min]->pass)
+            min = right;
+        if (min == i)
+            break;
+        heap_swap (i, min);
+        i = min;
+    }
+}
+
+/* Exchanges the threads at indexes I and J of the pass heap. */
+static void
+heap_swap (size_t i, size_t j)
+{
+    struct thread *t = pass_heap[i];
+
+    pass_heap[i] = pass_heap[j];
+    pass_heap[j] = t;
+    pass_heap[i]->heap_idx = i;
+    pass_heap[j]->heap_idx = j;
 }
 
 /* Completes a thread switch by activating the new thread's page
@@ -584,8 +1654,10 @@ thread_schedule_tail (struct thread *prev)
     /* Mark us as running. */
     cur->status = THREAD_RUNNING;
 
-    /* Start new time slice. */
-    thread_ticks = 0;
+    /* Start new time slice, unless handed the rest of one. */
+    if (!slice_handed_off)
+        thread_ticks = 0;
+    slice_handed_off = false;
 
 #ifdef USERPROG
     /* Activate the new address space. */
@@ -600,7 +1672,7 @@ thread_schedule_tail (struct thread *prev)
     if (prev != NULL && prev->status == THREAD_DYING && prev != initial_thread)
     {
         ASSERT (prev != cur);
-        palloc_free_page (prev);
+        free_thread_page (prev);
     }
 }
 
@@ -615,18 +1687,93 @@ static void
 schedule (void)
 {
     struct thread *cur = running_thread ();
-    struct thread *next = next_thread_to_run ();
+    struct thread *next = take_handoff (cur);
     struct thread *prev = NULL;
 
     ASSERT (intr_get_level () == INTR_OFF);
     ASSERT (cur->status != THREAD_RUNNING);
+
+    if (next != NULL)
+    {
+        slice_handed_off = true;
+        handoff_cnt++;
+    }
+    else
+        next = next_thread_to_run ();
     ASSERT (is_thread (next));
 
+    if (cur == idle_thread && next != idle_thread)
+        timer_idle_exit ();
     if (cur != next)
+    {
+        switch_cnt++;
+        trace_record (TRACE_SWITCH_OUT, cur);
+        trace_record (TRACE_SWITCH_IN, next);
         prev = switch_threads (cur, next);
+    }
     thread_schedule_tail (prev);
 }
 
+/* Clears CUR's handoff and returns the thread it named, removed
+   from the run queue, if that thread is still ready and no ready
+   thread comes before it: a real-time thread with an earlier
+   deadline or, under the priority schedulers, a thread of higher
+   priority.  Otherwise returns a null pointer.
+
+   CUR's handoff can only name a thread that has not run since
+   CUR made it ready, because on one CPU nothing else runs until
+   CUR is switched out, which clears the handoff. */
+static struct thread *
+take_handoff (struct thread *cur)
+{
+    struct thread *t = cur->handoff;
+
+    cur->handoff = NULL;
+    if (t == NULL || t == cur || t->status != THREAD_READY)
+        return NULL;
+    if (!list_empty (&rt_ready_list))
+    {
+        if (list_front (&rt_ready_list) != &t->elem)
+            return NULL;
+    }
+    else if (!pass_sched () && t->priority < ready_highest ())
+        return NULL;
+    ready_remove (t);
+    return t;
+}
+
+/* Hashes thread E by its tid. */
+static unsigned
+tid_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+    return hash_int (hash_entry (e, struct thread, tidelem)->tid);
+}
+
+/* Orders threads A and B by tid. */
+static bool
+tid_less (const struct hash_elem *a, const struct hash_elem *b,
+          void *aux UNUSED)
+{
+    return (hash_entry (a, struct thread, tidelem)->tid
+            < hash_entry (b, struct thread, tidelem)->tid);
+}
+
+/* Hashes child element E by its child's tid. */
+static unsigned
+child_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+    return hash_int (hash_entry (e, struct child_element, pid_elem)->child_pid);
+}
+
+/* Orders child elements A and B by their child's tid. */
+static bool
+child_less (const struct hash_elem *a, const struct hash_elem *b,
+            void *aux UNUSED)
+{
+    return (hash_entry (a, struct child_element, pid_elem)->child_pid
+            < hash_entry (b, struct child_element, pid_elem)->child_pid);
+}
+
 /* Returns a tid to use for a new thread. */
 static tid_t
 allocate_tid (void)
@@ -2,9 +2,13 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <hash.h>
 #include <list.h>
+#include <rusage.h>
 #include <stdint.h>
+#include "devices/timer.h"
 #include "threads/synch.h"
+#include "userprog/fdtable.h"
 
 
 
@@ -26,6 +30,20 @@ typedef int tid_t;
 #define PRI_DEFAULT 31                  /* Default priority. */
 #define PRI_MAX 63                      /* Highest priority. */
 
+/* Thread niceness values, for the MLFQS. */
+#define NICE_MIN -20                    /* Least nice to other threads. */
+#define NICE_DEFAULT 0                  /* Default niceness. */
+#define NICE_MAX 20                     /* Nicest to other threads. */
+
+/* Time slices, in timer ticks. */
+#define SLICE_DEFAULT 4                 /* Default time slice. */
+#define SLICE_MAX 1000                  /* Longest time slice. */
+
+/* Thread ticket counts, for the stride scheduler. */
+#define TICKETS_MIN 1                   /* Smallest share of the CPU. */
+#define TICKETS_DEFAULT 100             /* Default share. */
+#define TICKETS_MAX 10000               /* Largest share of the CPU. */
+
 #define STILL_ALIVE 2                   
 #define WAS_KILLED 0                    
 #define HAD_EXITED 1                    
@@ -83,10 +101,12 @@ typedef int tid_t;
    value, triggering the assertion. */
 /* The `elem' member has a dual purpose.  It can be an element in
    the run queue (thread.c), or it can be an element in a
-   semaphore wait list (synch.c).  It can be used these two ways
-   only because they are mutually exclusive: only a thread in the
-   ready state is on the run queue, whereas only a thread in the
-   blocked state is on a semaphore wait list. */
+   semaphore wait list (synch.c) or the timer's sleep list
+   (devices/timer.c).  It can be used these ways only because
+   they are mutually exclusive: only a thread in the ready state
+   is on the run queue, whereas only a thread in the blocked
+   state is on a wait list or the sleep list, and a blocked
+   thread waits for one thing at a time. */
 struct thread
 {
     /* Owned by thread.c. */
@@ -94,23 +114,63 @@ struct thread
     enum thread_status status;          /* Thread state. */
     char name[16];                      /* Name (for debugging purposes). */
     uint8_t *stack;                     /* Saved stack pointer. */
-    int priority;                       /* Priority. */
+    int priority;                       /* Effective priority. */
     struct list_elem allelem;           /* List element for all threads list. */
-
-    /* Shared between thread.c and synch.c. */
+    struct hash_elem tidelem;           /* Element in the tid table. */
+    int quantum;                        /* Own time slice, or 0. */
+    struct thread *handoff;             /* Thread to run next, or NULL. */
+
+    /* Shared between thread.c and synch.c, for priority donation. */
+    int base_priority;                  /* Priority before donations. */
+    struct list donors;                 /* Threads donating priority to us. */
+    struct list_elem donor_elem;        /* Element in a holder's `donors'. */
+    struct lock *waiting_lock;          /* Lock being waited on, if any. */
+
+    /* Owned by thread.c, used only by the MLFQS. */
+    int nice;                           /* Niceness. */
+    int recent_cpu;                     /* Recent CPU use, in fixed-point. */
+    bool cpu_dirty;                     /* On the priority recalc list? */
+    struct list_elem cpu_elem;          /* Priority recalc list element. */
+
+    /* Owned by thread.c, used only by the stride and CFS
+       schedulers.  Under CFS, pass is the virtual runtime. */
+    int tickets;                        /* Share of the CPU. */
+    int64_t pass;                       /* Virtual time; lowest runs next. */
+    size_t heap_idx;                    /* Index in the pass heap. */
+
+    /* Owned by thread.c, used only by real-time threads. */
+    bool rt;                            /* In the real-time class? */
+    bool rt_throttled;                  /* Out of budget this period? */
+    bool rt_missed;                     /* Current job missed deadline? */
+    int64_t rt_period;                  /* Ticks between job releases. */
+    int64_t rt_runtime;                 /* Budget per job, in ticks. */
+    int64_t rt_deadline;                /* Deadline, relative to release. */
+    int64_t rt_release;                 /* Release tick of current job. */
+    int64_t rt_abs_deadline;            /* Deadline tick of current job. */
+    int64_t rt_budget;                  /* Ticks left for current job. */
+    long long rt_misses;                /* # of deadlines missed. */
+
+    /* Shared between thread.c, synch.c and devices/timer.c. */
     struct list_elem elem;              /* List element. */
 
+    /* Owned by devices/timer.c. */
+    int64_t wakeup_tick;                /* Tick to wake up at, if sleeping. */
+    struct timer timeout_timer;         /* Ends a timed wait. */
+    bool timed_out;                     /* Last timed wait expired? */
+
+    /* Resource usage, updated by thread.c, userprog/exception.c
+       and userprog/syscall.c. */
+    struct rusage usage;                /* This thread's own usage. */
+    struct rusage child_usage;          /* Usage of waited-for children. */
+
 
 
    
-    struct list fd_list; 				
-    int fd_size;						
+    struct fd_table fds;                /* Open files, by descriptor. */
     
     struct file *exec_file;				
 
     
-    struct semaphore sema_exec;     
-    struct semaphore sema_wait;     
     struct list child_list;         
     struct thread * parent;         
 
@@ -128,12 +188,16 @@ struct thread
 struct child_element
 {
     struct list_elem child_elem;    //lista de elementos que se usarán para agregar en child_list
-    struct thread * real_child;     //puntero al hilo hijo real
     int exit_status;                //el estado con el que sale el hilo secundario
     int cur_status;                 //el estado actual del hilo secundario
     int child_pid;                  //pid de este niño
+    tid_t parent_tid;               //tid del padre que lo creó
+    struct hash_elem pid_elem;      //elemento en la tabla de hijos, indexada por pid
     bool first_time;                //para comprobar si wait() se llama antes
     bool loaded_success;            //para comprobar si la carga fue exitosa
+    struct semaphore sema_exec;     //se sube cuando el hijo termina de cargar
+    struct semaphore sema_wait;     //se sube cuando el hijo termina
+    struct rusage usage;            //uso de recursos del hijo y sus descendientes, al salir
 };
 
 /* If false (default), use round-robin scheduler.
@@ -141,10 +205,39 @@ struct child_element
    Controlled by kernel command-line option "-o mlfqs". */
 extern bool thread_mlfqs;
 
+/* Scheduling policies. */
+enum sched_policy
+{
+    SCHED_PRIORITY,     /* Strict priority, round-robin within one. */
+    SCHED_MLFQS,        /* Multi-level feedback queue. */
+    SCHED_STRIDE,       /* Proportional share by ticket count. */
+    SCHED_CFS           /* Fair share by virtual runtime, weighted by nice. */
+};
+
+/* Scheduling policy in use.  Controlled by kernel command-line
+   option "-sched=POLICY"; "-mlfqs" is the same as
+   "-sched=mlfqs". */
+extern enum sched_policy thread_sched;
+
+/* Number of timer ticks a thread may run before it is
+   preempted, unless it has a quantum of its own.  Controlled by
+   kernel command-line option "-slice=N". */
+extern int thread_time_slice;
+
+/* If true (default), pages of exited threads are recycled by
+   thread_create(). */
+extern bool thread_page_cache;
+
+/* If false (default), a thread woken by sema_up() waits its turn
+   in the run queue.  If true, it runs as soon as its waker blocks
+   or yields.  Controlled by kernel command-line option
+   "-handoff". */
+extern bool thread_handoff;
+
 void thread_init (void);
 void thread_start (void);
 
-void thread_tick (void);
+void thread_tick (bool user);
 void thread_print_stats (void);
 
 typedef void thread_func (void *aux);
@@ -159,6 +252,10 @@ const char *thread_name (void);
 
 void thread_exit (void) NO_RETURN;
 void thread_yield (void);
+void thread_yield_to (struct thread *);
+void thread_hint_handoff (struct thread *);
+void thread_preempt (void);
+void thread_check_preempt (void);
 
 /* Performs some operation on thread t, given auxiliary data AUX. */
 typedef void thread_action_func (struct thread *t, void *aux);
@@ -166,12 +263,28 @@ void thread_foreach (thread_action_func *, void *);
 
 int thread_get_priority (void);
 void thread_set_priority (int);
+bool thread_update_priority (struct thread *);
 
 int thread_get_nice (void);
 void thread_set_nice (int);
 int thread_get_recent_cpu (void);
 int thread_get_load_avg (void);
 
+int thread_get_tickets (void);
+void thread_set_tickets (int);
+
+int thread_get_quantum (void);
+void thread_set_quantum (int);
+
+bool thread_rt_set (int64_t period, int64_t runtime, int64_t deadline);
+void thread_rt_clear (void);
+void thread_rt_wait (void);
+long long thread_rt_get_misses (void);
+
 struct thread *thread_get (tid_t tid);
+struct child_element *thread_get_child (tid_t tid);
+struct child_element *thread_lock_child (tid_t tid);
+void thread_unlock_child (void);
+void thread_remove_child (struct child_element *);
 
 #endif /* threads/thread.h */
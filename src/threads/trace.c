@@ -0,0 +1,129 @@
+#include "threads/trace.h"
+#include <debug.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/interrupt.h"
+#include "threads/thread.h"
+#include "threads/tsc.h"
+
+/* Scheduler event trace.
+
+   Events go into a fixed-size ring buffer that is written with
+   interrupts off instead of under a lock, so that events can be
+   recorded from the scheduler and from interrupt handlers.  When
+   the buffer is full, the oldest events are overwritten.
+   trace_dump() prints the buffer to the console (and thus to the
+   serial port), where utils/sched-trace can decode it. */
+
+/* Number of events kept.  Must be a power of 2. */
+#define TRACE_BUF_CNT 4096
+
+/* One recorded event. */
+struct trace_entry
+  {
+    uint64_t tsc;               /* Time stamp counter. */
+    int tid;                    /* Thread identifier. */
+    uint8_t event;              /* A `enum trace_event'. */
+    uint8_t priority;           /* Thread's effective priority. */
+  };
+
+/* If false (default), scheduler events are not recorded.
+   Controlled by kernel command-line option "-trace". */
+bool trace_enabled;
+
+/* The ring buffer.  trace_head counts every event ever recorded,
+   so the newest event is at trace_head - 1 (mod TRACE_BUF_CNT). */
+static struct trace_entry trace_buf[TRACE_BUF_CNT];
+static uint64_t trace_head;
+
+/* Thread names captured by trace_dump().  Threads beyond the
+   first TRACE_NAME_CNT are identified by tid only. */
+#define TRACE_NAME_CNT 128
+struct trace_name
+  {
+    int tid;                    /* Thread identifier. */
+    char name[16];              /* Thread name. */
+  };
+static struct trace_name trace_names[TRACE_NAME_CNT];
+static int trace_name_cnt;
+
+/* Names of events, as printed by trace_dump(). */
+static const char *event_names[TRACE_EVENT_CNT] =
+  {
+    "switch-out", "switch-in", "block", "unblock", "yield", "tick",
+  };
+
+static void save_thread_name (struct thread *, void *aux);
+
+/* Appends EVENT for thread T to the trace buffer.  Use the
+   trace_record() macro instead of calling this directly. */
+void
+trace_log (enum trace_event event, const struct thread *t) 
+{
+  struct trace_entry *e;
+  enum intr_level old_level;
+
+  ASSERT (event < TRACE_EVENT_CNT);
+
+  old_level = intr_disable ();
+  e = &trace_buf[trace_head++ % TRACE_BUF_CNT];
+  e->tsc = rdtsc ();
+  e->tid = t->tid;
+  e->event = event;
+  e->priority = t->priority;
+  intr_set_level (old_level);
+}
+
+/* Prints the contents of the trace buffer, oldest event first,
+   and empties it.  Each line starts with "Trace:" so that
+   utils/sched-trace can pick the events out of the rest of the
+   console output. */
+void
+trace_dump (void) 
+{
+  uint64_t first, i;
+  int n;
+  bool was_enabled;
+  enum intr_level old_level;
+
+  /* Stop recording, so that printing doesn't trace itself, and
+     snapshot the names of the live threads.  Printing may sleep,
+     so it can't be done while walking the thread list. */
+  old_level = intr_disable ();
+  was_enabled = trace_enabled;
+  trace_enabled = false;
+  trace_name_cnt = 0;
+  thread_foreach (save_thread_name, NULL);
+  intr_set_level (old_level);
+
+  first = trace_head > TRACE_BUF_CNT ? trace_head - TRACE_BUF_CNT : 0;
+  printf ("Trace: begin %"PRIu64" events, %"PRIu64" overwritten\n",
+          trace_head - first, first);
+  for (n = 0; n < trace_name_cnt; n++)
+    printf ("Trace: thread %d %s\n", trace_names[n].tid, trace_names[n].name);
+
+  for (i = first; i < trace_head; i++) 
+    {
+      const struct trace_entry *e = &trace_buf[i % TRACE_BUF_CNT];
+      printf ("Trace: %"PRIu64" %s %d %d\n",
+              e->tsc, event_names[e->event], e->tid, e->priority);
+    }
+  printf ("Trace: end\n");
+
+  trace_head = 0;
+  trace_enabled = was_enabled;
+}
+
+/* Saves the tid and name of thread T, for trace_dump(). */
+static void
+save_thread_name (struct thread *t, void *aux UNUSED) 
+{
+  if (trace_name_cnt < TRACE_NAME_CNT) 
+    {
+      struct trace_name *n = &trace_names[trace_name_cnt++];
+      n->tid = t->tid;
+      strlcpy (n->name, t->name, sizeof n->name);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef THREADS_TRACE_H
+#define THREADS_TRACE_H
+
+#include <stdbool.h>
+
+struct thread;
+
+/* Scheduler events recorded in the trace buffer. */
+enum trace_event
+  {
+    TRACE_SWITCH_OUT,           /* Thread gave up the CPU. */
+    TRACE_SWITCH_IN,            /* Thread got the CPU. */
+    TRACE_BLOCK,                /* Thread blocked. */
+    TRACE_UNBLOCK,              /* Thread was made ready. */
+    TRACE_YIELD,                /* Thread yielded. */
+    TRACE_TICK,                 /* Timer tick while thread ran. */
+    TRACE_EVENT_CNT             /* Number of event types. */
+  };
+
+/* If false (default), scheduler events are not recorded.
+   Controlled by kernel command-line option "-trace". */
+extern bool trace_enabled;
+
+void trace_log (enum trace_event, const struct thread *);
+void trace_dump (void);
+
+/* Records EVENT for thread T if tracing is enabled.  When it is
+   not, this costs one load and one branch. */
+#define trace_record(EVENT, T)                  \
+        do                                      \
+          {                                     \
+            if (trace_enabled)                  \
+              trace_log (EVENT, T);             \
+          }                                     \
+        while (0)
+
+#endif /* threads/trace.h */
@@ -0,0 +1,18 @@
+#ifndef THREADS_TSC_H
+#define THREADS_TSC_H
+
+#include <stdint.h>
+
+/* Reads the CPU's time stamp counter, which counts clock cycles
+   since reset.  Useful for timing intervals much shorter than a
+   timer tick. */
+static inline uint64_t
+rdtsc (void) 
+{
+  /* See [IA32-v2b] "RDTSC". */
+  uint64_t tsc;
+  asm volatile ("rdtsc" : "=A" (tsc));
+  return tsc;
+}
+
+#endif /* threads/tsc.h */
@@ -0,0 +1,285 @@
+#include "threads/workqueue.h"
+#include <debug.h>
+#include <stdio.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+
+/* Kernel work queue.
+
+   Work items are kept on a single FIFO queue served by a small
+   pool of worker threads.  queue_work() may be called from
+   interrupt handlers, so the queue is protected by disabling
+   interrupts rather than by a lock.
+
+   work_sema counts the items a worker may take.  A worker that
+   wakes up takes as many more items as it can without blocking,
+   up to WORK_BATCH_MAX, so that a burst of queued work costs one
+   wakeup instead of one per item.
+
+   Every item gets a ticket in queueing order.  flush_work()
+   waits until no item with a smaller ticket than the next one
+   to be handed out is still queued or running.  Because the
+   queue is FIFO, that only requires looking at the front of the
+   queue and at the item each worker is running. */
+
+/* Most worker threads that may be started. */
+#define WORKERS_MAX 8
+
+/* Most items handled per wakeup. */
+#define WORK_BATCH_MAX 16
+
+/* A worker thread. */
+struct worker
+  {
+    struct thread *thread;      /* The worker's thread. */
+    bool busy;                  /* Running an item? */
+    unsigned ticket;            /* If busy, ticket of that item. */
+  };
+
+/* A thread waiting in flush_work(). */
+struct flusher
+  {
+    struct list_elem elem;      /* Element in flush_list. */
+    unsigned ticket;            /* Wait for tickets before this. */
+    struct semaphore done;      /* Upped when they have finished. */
+  };
+
+/* Number of worker threads started by workqueue_init().
+   Controlled by kernel command-line option "-workers=N". */
+int workqueue_workers = 2;
+
+static struct list work_list;   /* Queued items. */
+static struct semaphore work_sema; /* Items not yet claimed. */
+static struct list flush_list;  /* Threads in flush_work(). */
+static unsigned next_ticket;    /* Ticket for the next item. */
+static struct worker workers[WORKERS_MAX];
+
+/* Statistics. */
+static long long queued_cnt;    /* # of items queued. */
+static long long started_cnt;   /* # of items started. */
+static long long batch_cnt;     /* # of worker wakeups. */
+static unsigned depth;          /* # of items now queued. */
+static unsigned max_depth;      /* Greatest value of depth. */
+static int64_t latency_sum;     /* Total ticks from queueing to start. */
+static int64_t latency_max;     /* Longest of those. */
+
+static thread_func worker_loop NO_RETURN;
+static bool ticket_before (unsigned a, unsigned b);
+static unsigned oldest_unfinished (void);
+static void wake_flushers (void);
+
+/* Initializes the work queue and starts workqueue_workers
+   worker threads.  Must be called after thread_start() and
+   before any work is queued. */
+void
+workqueue_init (void)
+{
+  int i;
+
+  list_init (&work_list);
+  sema_init (&work_sema, 0);
+  list_init (&flush_list);
+
+  if (workqueue_workers < 1)
+    workqueue_workers = 1;
+  else if (workqueue_workers > WORKERS_MAX)
+    workqueue_workers = WORKERS_MAX;
+
+  for (i = 0; i < workqueue_workers; i++)
+    {
+      char name[24];
+
+      snprintf (name, sizeof name, "worker %d", i);
+      if (thread_create (name, PRI_DEFAULT, worker_loop, &workers[i])
+          == TID_ERROR)
+        PANIC ("cannot start work queue worker");
+    }
+}
+
+/* Initializes W to run FUNC when queued. */
+void
+work_init (struct work *w, work_func *func)
+{
+  ASSERT (w != NULL);
+  ASSERT (func != NULL);
+
+  w->func = func;
+  w->pending = false;
+}
+
+/* Queues W to be run by a worker thread.  Returns true if W was
+   queued, false if it was already queued and has not started
+   running yet.  W may be queued again once its function has
+   started, even from within that function.
+
+   May be called from an interrupt handler. */
+bool
+queue_work (struct work *w)
+{
+  enum intr_level old_level;
+
+  ASSERT (w != NULL);
+
+  old_level = intr_disable ();
+  if (w->pending)
+    {
+      intr_set_level (old_level);
+      return false;
+    }
+  w->pending = true;
+  w->ticket = next_ticket++;
+  w->queued_tick = timer_ticks ();
+  list_push_back (&work_list, &w->elem);
+  queued_cnt++;
+  if (++depth > max_depth)
+    max_depth = depth;
+  intr_set_level (old_level);
+
+  sema_up (&work_sema);
+  return true;
+}
+
+/* Waits until every item queued before this call has finished
+   running.  Items queued meanwhile, including any queued by the
+   items being waited for, are not waited for.  Must not be
+   called from a work function. */
+void
+flush_work (void)
+{
+  struct flusher f;
+  enum intr_level old_level;
+  int i;
+
+  ASSERT (!intr_context ());
+  for (i = 0; i < workqueue_workers; i++)
+    ASSERT (workers[i].thread != thread_current ());
+
+  old_level = intr_disable ();
+  f.ticket = next_ticket;
+  if (ticket_before (oldest_unfinished (), f.ticket))
+    {
+      sema_init (&f.done, 0);
+      list_push_back (&flush_list, &f.elem);
+      sema_down (&f.done);
+    }
+  intr_set_level (old_level);
+}
+
+/* Prints work queue statistics. */
+void
+workqueue_print_stats (void)
+{
+  printf ("Workqueue: %lld items in %lld batches, max depth %u, "
+          "latency avg %lld max %lld ticks\n",
+          queued_cnt, batch_cnt, max_depth,
+          started_cnt > 0 ? latency_sum / started_cnt : 0,
+          latency_max);
+}
+
+/* Worker thread W_. */
+static void
+worker_loop (void *w_)
+{
+  struct worker *w = w_;
+
+  w->thread = thread_current ();
+  for (;;)
+    {
+      struct list batch;
+      enum intr_level old_level;
+      int cnt;
+
+      /* Wait for work, then take a batch of it. */
+      sema_down (&work_sema);
+      list_init (&batch);
+      old_level = intr_disable ();
+      cnt = 0;
+      do
+        {
+          ASSERT (!list_empty (&work_list));
+          list_push_back (&batch, list_pop_front (&work_list));
+          depth--;
+        }
+      while (++cnt < WORK_BATCH_MAX && sema_try_down (&work_sema));
+      batch_cnt++;
+      w->busy = true;
+      w->ticket = list_entry (list_front (&batch), struct work, elem)->ticket;
+      intr_set_level (old_level);
+
+      /* Run the batch.  A work function may free its item, so it
+         must not be touched once its function has been called. */
+      while (!list_empty (&batch))
+        {
+          struct work *item = list_entry (list_pop_front (&batch),
+                                          struct work, elem);
+          int64_t latency;
+
+          old_level = intr_disable ();
+          w->ticket = item->ticket;
+          item->pending = false;
+          started_cnt++;
+          latency = timer_ticks () - item->queued_tick;
+          latency_sum += latency;
+          if (latency > latency_max)
+            latency_max = latency;
+          intr_set_level (old_level);
+
+          item->func (item);
+        }
+
+      old_level = intr_disable ();
+      w->busy = false;
+      wake_flushers ();
+      intr_set_level (old_level);
+    }
+}
+
+/* Returns true if ticket A was handed out before ticket B,
+   allowing for wraparound. */
+static bool
+ticket_before (unsigned a, unsigned b)
+{
+  return (int) (a - b) < 0;
+}
+
+/* Returns the ticket of the oldest item that is queued or
+   running, or next_ticket if there is none.  Must be called with
+   interrupts off. */
+static unsigned
+oldest_unfinished (void)
+{
+  unsigned oldest = next_ticket;
+  int i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if (!list_empty (&work_list))
+    oldest = list_entry (list_front (&work_list), struct work, elem)->ticket;
+  for (i = 0; i < workqueue_workers; i++)
+    if (workers[i].busy && ticket_before (workers[i].ticket, oldest))
+      oldest = workers[i].ticket;
+  return oldest;
+}
+
+/* Wakes up the threads in flush_work() whose items have all
+   finished.  Must be called with interrupts off. */
+static void
+wake_flushers (void)
+{
+  unsigned oldest = oldest_unfinished ();
+  struct list_elem *e;
+
+  for (e = list_begin (&flush_list); e != list_end (&flush_list); )
+    {
+      struct flusher *f = list_entry (e, struct flusher, elem);
+
+      e = list_next (e);
+      if (!ticket_before (oldest, f->ticket))
+        {
+          list_remove (&f->elem);
+          sema_up (&f->done);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef THREADS_WORKQUEUE_H
+#define THREADS_WORKQUEUE_H
+
+#include <list.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* A deferred work item.
+
+   A subsystem that wants to move work off its hot path embeds a
+   struct work in the data the work needs, initializes it with
+   work_init(), and hands it to queue_work().  Some time later a
+   worker thread calls the work function with a pointer to the
+   struct work, from which the function can recover its data
+   with list_entry()-style pointer arithmetic:
+
+        struct cleanup
+          {
+            struct work work;
+            void *buffer;
+          };
+
+        static void
+        do_cleanup (struct work *w)
+        {
+          struct cleanup *c = (struct cleanup *) w;
+          free (c->buffer);
+          free (c);
+        }
+
+   Work functions run in a kernel thread, so they may sleep,
+   acquire locks, and allocate memory. */
+struct work;
+typedef void work_func (struct work *);
+
+struct work
+  {
+    struct list_elem elem;      /* Element in the work queue. */
+    work_func *func;            /* Function to run. */
+    unsigned ticket;            /* Position in queueing order. */
+    int64_t queued_tick;        /* Timer tick when queued. */
+    bool pending;               /* Queued but not yet started? */
+  };
+
+/* Number of worker threads started by workqueue_init().
+   Controlled by kernel command-line option "-workers=N". */
+extern int workqueue_workers;
+
+void workqueue_init (void);
+void work_init (struct work *, work_func *);
+bool queue_work (struct work *);
+void flush_work (void);
+void workqueue_print_stats (void);
+
+#endif /* threads/workqueue.h */
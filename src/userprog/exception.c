@@ -5,6 +5,7 @@
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "userprog/syscall.h"
+#include "userprog/uaccess.h"
 
 /* Number of page faults processed. */
 static long long page_fault_cnt;
@@ -143,12 +144,25 @@ page_fault (struct intr_frame *f)
 
   /* Count page faults. */
   page_fault_cnt++;
+  thread_current ()->usage.page_faults++;
 
   /* Determine cause. */
   not_present = (f->error_code & PF_P) == 0;
   write = (f->error_code & PF_W) != 0;
   user = (f->error_code & PF_U) != 0;
 
+  /* A fault in one of the user memory accessors in uaccess.c
+     resumes at its fixup code, which makes the accessor fail. */
+  if (!user)
+    {
+      void *fixup = uaccess_fixup (f->eip);
+      if (fixup != NULL)
+        {
+          f->eip = fixup;
+          return;
+        }
+    }
+
   /* To implement virtual memory, delete the rest of the function
      body, and replace it with code that brings in the page to
      which fault_addr refers. */
@@ -0,0 +1,146 @@
+#include "userprog/fdtable.h"
+#include <debug.h>
+#include <stdbool.h>
+#include <string.h>
+#include "threads/malloc.h"
+
+/* File descriptor tables.
+
+   A table is an array of open files indexed by file descriptor,
+   so looking up a descriptor is a bounds check and an array
+   access.  Alongside it, free_map has a bit set for each free
+   descriptor.  open() gets the lowest free one by finding the
+   first nonzero word of free_map and its lowest set bit, so
+   descriptors are reused as soon as they are closed and the
+   table stays as small as the largest number of files the
+   process has had open at once.  When no descriptor is free,
+   the table doubles in size. */
+
+/* Bits per word of free_map. */
+#define MAP_BITS 32
+
+/* Number of fds in a new table.  Must be a multiple of
+   MAP_BITS. */
+#define FD_TABLE_INIT 32
+
+static int find_free (const struct fd_table *);
+static bool grow (struct fd_table *);
+
+/* Adds FILE to table T under the lowest free file descriptor and
+   returns that descriptor, or returns -1 if memory to grow the
+   table cannot be allocated. */
+int
+fd_table_add (struct fd_table *t, struct file *file) 
+{
+  int fd;
+
+  ASSERT (file != NULL);
+
+  fd = find_free (t);
+  if (fd < 0) 
+    {
+      if (!grow (t))
+        return -1;
+      fd = find_free (t);
+      ASSERT (fd >= 0);
+    }
+  t->files[fd] = file;
+  t->free_map[fd / MAP_BITS] &= ~((uint32_t) 1 << fd % MAP_BITS);
+  return fd;
+}
+
+/* Returns the file open as FD in table T, or a null pointer if
+   FD is not open. */
+struct file *
+fd_table_get (const struct fd_table *t, int fd) 
+{
+  if (fd < FD_MIN || fd >= t->cap)
+    return NULL;
+  return t->files[fd];
+}
+
+/* Removes FD from table T and returns the file that was open as
+   FD, or returns a null pointer if FD is not open.  FD becomes
+   free for reuse. */
+struct file *
+fd_table_remove (struct fd_table *t, int fd) 
+{
+  struct file *file = fd_table_get (t, fd);
+
+  if (file != NULL) 
+    {
+      t->files[fd] = NULL;
+      t->free_map[fd / MAP_BITS] |= (uint32_t) 1 << fd % MAP_BITS;
+    }
+  return file;
+}
+
+/* Returns a bound on the file descriptors open in table T: all of
+   them are less than the value returned. */
+int
+fd_table_end (const struct fd_table *t) 
+{
+  return t->cap;
+}
+
+/* Frees the memory held by table T, which leaves it empty.  The
+   files open in T, if any, are not closed. */
+void
+fd_table_destroy (struct fd_table *t) 
+{
+  free (t->files);
+  free (t->free_map);
+  memset (t, 0, sizeof *t);
+}
+
+/* Returns the lowest free file descriptor in table T, or -1 if
+   none is free. */
+static int
+find_free (const struct fd_table *t) 
+{
+  int i;
+
+  for (i = 0; i < t->cap / MAP_BITS; i++)
+    if (t->free_map[i] != 0)
+      return i * MAP_BITS + __builtin_ctz (t->free_map[i]);
+  return -1;
+}
+
+/* Doubles the size of table T, or gives it its first FD_TABLE_INIT
+   descriptors.  Returns true if successful, false if memory
+   cannot be allocated, in which case T is unchanged. */
+static bool
+grow (struct fd_table *t) 
+{
+  int new_cap = t->cap > 0 ? t->cap * 2 : FD_TABLE_INIT;
+  struct file **files;
+  uint32_t *free_map;
+
+  files = malloc (new_cap * sizeof *files);
+  free_map = malloc (new_cap / MAP_BITS * sizeof *free_map);
+  if (files == NULL || free_map == NULL) 
+    {
+      free (files);
+      free (free_map);
+      return false;
+    }
+
+  /* The new descriptors are all free, except that 0 and 1, which
+     are the console, are never handed out. */
+  memset (files, 0, new_cap * sizeof *files);
+  memset (free_map, 0xff, new_cap / MAP_BITS * sizeof *free_map);
+  if (t->cap > 0) 
+    {
+      memcpy (files, t->files, t->cap * sizeof *files);
+      memcpy (free_map, t->free_map, t->cap / MAP_BITS * sizeof *free_map);
+    }
+  else
+    free_map[0] &= ~(((uint32_t) 1 << FD_MIN) - 1);
+
+  free (t->files);
+  free (t->free_map);
+  t->files = files;
+  t->free_map = free_map;
+  t->cap = new_cap;
+  return true;
+}
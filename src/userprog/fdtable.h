@@ -0,0 +1,26 @@
+#ifndef USERPROG_FDTABLE_H
+#define USERPROG_FDTABLE_H
+
+#include <stdint.h>
+
+struct file;
+
+/* Lowest file descriptor for a file; 0 and 1 are the console. */
+#define FD_MIN 2
+
+/* A process's open files, indexed by file descriptor.  A table
+   that is all zeros is empty and needs no initialization. */
+struct fd_table
+  {
+    struct file **files;        /* Open files, indexed by fd. */
+    uint32_t *free_map;         /* Bit set for each free fd. */
+    int cap;                    /* Number of fds in FILES. */
+  };
+
+int fd_table_add (struct fd_table *, struct file *);
+struct file *fd_table_get (const struct fd_table *, int fd);
+struct file *fd_table_remove (struct fd_table *, int fd);
+int fd_table_end (const struct fd_table *);
+void fd_table_destroy (struct fd_table *);
+
+#endif /**< userprog/fdtable.h */
@@ -0,0 +1,270 @@
+#include "userprog/futex.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <round.h>
+#include <stdint.h>
+#include "devices/timer.h"
+#include "threads/interrupt.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "userprog/pagedir.h"
+
+/* Futexes.
+
+   A futex is an aligned int in user memory that user programs
+   use to build their own locks and barriers, entering the kernel
+   only to sleep while the word holds a given value and to wake
+   sleepers after changing it.
+
+   A futex is identified by the kernel virtual address of its
+   word rather than by the user address, so that it names the
+   same futex in every process that maps the page.  Waiters are
+   kept in per-futex queues, which are created when the first
+   thread waits and freed when the last one leaves, and which are
+   found through a hash table keyed by that address.  futex_lock
+   protects the table and the queues.
+
+   Only a thread other than the waiter can wake a waiter, and it
+   must reach the same word.  That takes either a process with
+   more than one thread or two processes sharing a page.  This
+   kernel has neither yet, so for now futex_wait() returns only
+   with FUTEX_CHANGED or FUTEX_TIMEOUT.  A wait without a timeout
+   could never end, and a thread in thread_block() cannot be
+   killed, so futex_wait() refuses one until something can wake
+   it. */
+
+/* Threads waiting on one futex. */
+struct futex_queue
+  {
+    struct hash_elem elem;      /* Element in futex_table. */
+    const int *key;             /* Kernel address of the word. */
+    struct list waiters;        /* List of struct futex_waiter. */
+  };
+
+/* A thread in futex_wait(). */
+struct futex_waiter
+  {
+    struct list_elem elem;      /* Element in a queue's `waiters'. */
+    struct thread *thread;      /* The waiting thread. */
+    bool woken;                 /* Removed by futex_wake()? */
+    bool asleep;                /* Still in the sleep futex_wake() ends? */
+  };
+
+static struct hash futex_table;
+static struct lock futex_lock;
+
+static hash_hash_func queue_hash;
+static hash_less_func queue_less;
+static const int *futex_key (int *uaddr);
+static struct futex_queue *find_queue (const int *key);
+static void remove_waiter (struct futex_queue *, struct futex_waiter *);
+static bool waiter_less (const struct list_elem *, const struct list_elem *,
+                         void *aux);
+
+/* Initializes the futex table. */
+void
+futex_init (void) 
+{
+  if (!hash_init (&futex_table, queue_hash, queue_less, NULL))
+    PANIC ("cannot allocate futex table");
+  lock_init (&futex_lock);
+}
+
+/* If the int at user address UADDR holds VAL, sleeps until
+   futex_wake() is called on it or until TIMEOUT_MS milliseconds
+   have passed.  Checking the value and going to sleep are atomic
+   with respect to futex_wake().
+
+   Returns FUTEX_WOKEN, FUTEX_CHANGED if the word did not hold
+   VAL, or FUTEX_TIMEOUT, or -1 if UADDR is not aligned, if
+   TIMEOUT_MS is negative (FUTEX_FOREVER), or if memory is
+   exhausted.  UADDR must already have been checked to
+   be a valid user address.  (See the comment at the top of the
+   file about who can call futex_wake().) */
+int
+futex_wait (int *uaddr, int val, int timeout_ms) 
+{
+  const int *key = futex_key (uaddr);
+  struct futex_queue *q;
+  struct futex_waiter w;
+  int64_t deadline;
+  enum intr_level old_level;
+  int result;
+
+  if (key == NULL || timeout_ms < 0)
+    return -1;
+  deadline = (timer_ticks ()
+              + DIV_ROUND_UP ((int64_t) timeout_ms * TIMER_FREQ, 1000));
+
+  lock_acquire (&futex_lock);
+  if (*key != val)
+    {
+      lock_release (&futex_lock);
+      return FUTEX_CHANGED;
+    }
+  if (timeout_ms == 0)
+    {
+      lock_release (&futex_lock);
+      return FUTEX_TIMEOUT;
+    }
+
+  q = find_queue (key);
+  if (q == NULL)
+    {
+      q = malloc (sizeof *q);
+      if (q == NULL)
+        {
+          lock_release (&futex_lock);
+          return -1;
+        }
+      q->key = key;
+      list_init (&q->waiters);
+      hash_insert (&futex_table, &q->elem);
+    }
+  w.thread = thread_current ();
+  w.woken = false;
+  w.asleep = false;
+  list_push_back (&q->waiters, &w.elem);
+
+  /* Release futex_lock and sleep atomically.  Releasing the lock
+     may yield to a waker, so check whether it already woke us
+     before going to sleep.  ASLEEP is true only from just before
+     the sleep to just after it, with interrupts off throughout,
+     so once it is false again futex_wake() will not touch us,
+     even after the timeout fires and we block on futex_lock
+     below. */
+  old_level = intr_disable ();
+  lock_release (&futex_lock);
+  if (!w.woken)
+    {
+      w.asleep = true;
+      timer_block_until (deadline);
+      w.asleep = false;
+    }
+  intr_set_level (old_level);
+
+  /* If the timeout expired, we are still in the queue. */
+  lock_acquire (&futex_lock);
+  if (w.woken)
+    result = FUTEX_WOKEN;
+  else
+    {
+      remove_waiter (find_queue (key), &w);
+      result = FUTEX_TIMEOUT;
+    }
+  lock_release (&futex_lock);
+  return result;
+}
+
+/* Wakes up to CNT threads waiting on the int at user address
+   UADDR, highest priority first, and returns the number woken,
+   or -1 if UADDR is not aligned.  UADDR must already have been
+   checked to be a valid user address. */
+int
+futex_wake (int *uaddr, int cnt) 
+{
+  const int *key = futex_key (uaddr);
+  struct futex_queue *q;
+  int woken = 0;
+
+  if (key == NULL)
+    return -1;
+
+  lock_acquire (&futex_lock);
+  q = find_queue (key);
+  while (q != NULL && woken < cnt) 
+    {
+      struct futex_waiter *w = list_entry (list_max (&q->waiters,
+                                                     waiter_less, NULL),
+                                           struct futex_waiter, elem);
+      enum intr_level old_level;
+      bool last = list_size (&q->waiters) == 1;
+
+      remove_waiter (q, w);
+      if (last)
+        q = NULL;
+
+      /* A waiter that is not asleep has yet to go to sleep, and
+         will see WOKEN and not do so, or has already woken up
+         from a timeout.  A waiter that is asleep may also have
+         had its timeout fire but not yet have run, in which case
+         timer_wake() does nothing. */
+      old_level = intr_disable ();
+      w->woken = true;
+      if (w->asleep)
+        timer_wake (w->thread);
+      intr_set_level (old_level);
+      woken++;
+    }
+  lock_release (&futex_lock);
+
+  thread_check_preempt ();
+  return woken;
+}
+
+/* Returns the kernel address of the int at user address UADDR,
+   or a null pointer if UADDR is not suitably aligned. */
+static const int *
+futex_key (int *uaddr) 
+{
+  if ((uintptr_t) uaddr % sizeof *uaddr != 0)
+    return NULL;
+  return pagedir_get_page (thread_current ()->pagedir, uaddr);
+}
+
+/* Returns the queue for the futex at KEY, or a null pointer if
+   nobody is waiting on it.  futex_lock must be held. */
+static struct futex_queue *
+find_queue (const int *key) 
+{
+  struct futex_queue q;
+  struct hash_elem *e;
+
+  q.key = key;
+  e = hash_find (&futex_table, &q.elem);
+  return e != NULL ? hash_entry (e, struct futex_queue, elem) : NULL;
+}
+
+/* Removes W from Q, freeing Q if it becomes empty.  futex_lock
+   must be held. */
+static void
+remove_waiter (struct futex_queue *q, struct futex_waiter *w) 
+{
+  list_remove (&w->elem);
+  if (list_empty (&q->waiters))
+    {
+      hash_delete (&futex_table, &q->elem);
+      free (q);
+    }
+}
+
+/* Hashes futex queue E by its key. */
+static unsigned
+queue_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct futex_queue *q = hash_entry (e, struct futex_queue, elem);
+  return hash_bytes (&q->key, sizeof q->key);
+}
+
+/* Orders futex queues A and B by key. */
+static bool
+queue_less (const struct hash_elem *a, const struct hash_elem *b,
+            void *aux UNUSED) 
+{
+  return (hash_entry (a, struct futex_queue, elem)->key
+          < hash_entry (b, struct futex_queue, elem)->key);
+}
+
+/* Returns true if the thread waiting in A_ has a lower priority
+   than the one waiting in B_. */
+static bool
+waiter_less (const struct list_elem *a_, const struct list_elem *b_,
+             void *aux UNUSED) 
+{
+  const struct futex_waiter *a = list_entry (a_, struct futex_waiter, elem);
+  const struct futex_waiter *b = list_entry (b_, struct futex_waiter, elem);
+
+  return a->thread->priority < b->thread->priority;
+}
@@ -0,0 +1,10 @@
+#ifndef USERPROG_FUTEX_H
+#define USERPROG_FUTEX_H
+
+#include <futex.h>
+
+void futex_init (void);
+int futex_wait (int *uaddr, int val, int timeout_ms);
+int futex_wake (int *uaddr, int cnt);
+
+#endif /**< userprog/futex.h */
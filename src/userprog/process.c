@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <wait.h>
 #include "userprog/gdt.h"
 #include "userprog/pagedir.h"
 #include "userprog/tss.h"
@@ -22,6 +23,7 @@
 
 
 void free_children(struct list *child_list);
+static void rusage_add (struct rusage *sum, const struct rusage *usage);
 static thread_func start_process NO_RETURN;
 static bool load (const char *cmdline, void (**eip) (void), void **esp);
 static void get_stack_args(char *file_name, void **esp, char **save_ptr);
@@ -77,16 +79,15 @@ start_process (void *file_name_)
     if_.eflags = FLAG_IF | FLAG_MBS;
     success = load (file_name, &if_.eip, &if_.esp);
 
-    // si el thread tiene padre
-    if(thread_current()->parent != NULL)
+    // si el thread tiene padre, tenerlo como hijo
+    struct child_element *child = thread_lock_child(thread_current() -> tid);
+    if(child != NULL)
     {
-        // tenerlo como hijo
-        struct child_element *child = get_child(thread_current() -> tid, &thread_current()->parent->child_list);
         // ajustando el estado load
         child ->loaded_success = success;
+        sema_up(&child -> sema_exec);
+        thread_unlock_child();
     }
-    
-    sema_up(&thread_current() -> sema_exec);
 
     
     palloc_free_page(file_name);
@@ -116,23 +117,48 @@ start_process (void *file_name_)
 int
 process_wait (tid_t tid)
 {
-    
-    struct child_element *child = get_child(tid, &thread_current()-> child_list);
-    
-    if(child -> first_time)
+    int status;
+
+    if (process_wait_timeout(tid, -1, &status) != WAIT_EXITED)
     {
-       
-        child -> first_time = false;
-        
-        if(child -> cur_status == STILL_ALIVE)
-        {
-            
-            sema_down(&(child -> real_child -> sema_wait));
-        }
-        
-        return child-> exit_status;
+        return -1;
+    }
+    return status;
+}
+
+/* Como process_wait(), pero deja de esperar despues de TIMEOUT ticks
+   del temporizador, si TIMEOUT no es negativo. Devuelve WAIT_EXITED
+   y guarda el estado de salida en *STATUS, WAIT_TIMEOUT si el hijo
+   sigue vivo (y se le puede esperar de nuevo), o -1 si TID no es un
+   hijo que se pueda esperar. */
+int
+process_wait_timeout (tid_t tid, int64_t timeout, int *status)
+{
+    struct child_element *child = get_child(tid);
+
+    if(child == NULL || !child -> first_time)
+    {
+        return -1;
+    }
+
+    // esperar siempre al semaforo, aunque cur_status diga que el hijo
+    // ya salio: exit() cambia cur_status antes de que process_exit()
+    // rellene child->usage, y sema_wait solo se sube despues
+    if (timeout < 0)
+    {
+        sema_down(&child -> sema_wait);
     }
-    return -1;
+    else if (!sema_down_timeout(&child -> sema_wait, timeout))
+    {
+        return WAIT_TIMEOUT;
+    }
+    child -> first_time = false;
+
+    // sumar el uso de recursos del hijo al del padre
+    rusage_add(&thread_current()->child_usage, &child->usage);
+
+    *status = child -> exit_status;
+    return WAIT_EXITED;
 }
 
 /* Free the current process's resources. */
@@ -143,21 +169,27 @@ process_exit (void)
     uint32_t *pd;
 
     
-    if(thread_current()->parent != NULL)
+    // la tabla queda bloqueada hasta el ultimo acceso, para que el
+    // padre no pueda liberar el elemento mientras tanto
+    struct child_element *child = thread_lock_child(thread_current() -> tid);
+    if(child != NULL)
     {
         
-        struct child_element *child = get_child(thread_current() -> tid, &thread_current()->parent->child_list);
-        
         if(child -> cur_status == STILL_ALIVE)
         {
             
             child -> cur_status = WAS_KILLED;
             child -> exit_status = -1;
         }
-    }
 
-    
-    sema_up(&thread_current()->sema_wait);
+        // dejar el uso de recursos para el padre
+        enum intr_level old_level = intr_disable();
+        child -> usage = cur -> usage;
+        intr_set_level(old_level);
+        rusage_add(&child -> usage, &cur -> child_usage);
+        sema_up(&child -> sema_wait);
+        thread_unlock_child();
+    }
 
     //liberar hijo
     free_children(&thread_current()->child_list);
@@ -175,7 +207,7 @@ process_exit (void)
     file_close(cur->exec_file);
 
     
-    close_all(&cur->fd_list);
+    close_all();
 
     /* Destroy the current process's page directory and switch back
      to the kernel-only page directory. */
@@ -207,11 +239,24 @@ free_children(struct list *child_list)
         struct list_elem* next = list_next(e1);
         struct child_element* c = list_entry(e1, struct child_element, child_elem);
         list_remove(e1);
+        thread_remove_child(c);
         free(c);
         e1 = next;
     }
 }
 
+/* Adds each counter in USAGE to the one in SUM. */
+static void
+rusage_add (struct rusage *sum, const struct rusage *usage)
+{
+    sum->user_ticks += usage->user_ticks;
+    sum->kernel_ticks += usage->kernel_ticks;
+    sum->voluntary_switches += usage->voluntary_switches;
+    sum->involuntary_switches += usage->involuntary_switches;
+    sum->page_faults += usage->page_faults;
+    sum->syscalls += usage->syscalls;
+}
+
 /* Sets up the CPU for running user code in the current
    thread.
    This function is called on every context switch. */
@@ -5,6 +5,7 @@
 
 tid_t process_execute (const char *file_name);
 int process_wait (tid_t);
+int process_wait_timeout (tid_t, int64_t timeout, int *status);
 void process_exit (void);
 void process_activate (void);
 
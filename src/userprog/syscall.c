@@ -1,23 +1,30 @@
 #include "userprog/syscall.h"
 #include <stdio.h>
+#include <inttypes.h>
+#include <round.h>
+#include <limits.h>
 #include <syscall-nr.h>
+#include <wait.h>
 #include "threads/interrupt.h"
 #include "threads/vaddr.h"
 #include "threads/malloc.h"
 #include "devices/shutdown.h"
 #include "devices/input.h"
+#include "devices/timer.h"
 #include "process.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
 #include "threads/synch.h"
+#include "threads/tsc.h"
+#include "userprog/futex.h"
+#include "userprog/uaccess.h"
 
-
-struct child_element* get_child(tid_t tid,struct list *mylist);
-void fd_init(struct fd_element *file_d, int fd_, struct file *myfile_);
+struct child_element* get_child(tid_t tid);
 static void syscall_handler (struct intr_frame *);
-struct fd_element* get_fd(int fd);
+static struct file *get_file (int fd);
 int write (int fd, const void *buffer_, unsigned size);
 int wait (tid_t pid);
+int wait_timeout (tid_t pid, int timeout_ms, int *status);
 bool create (const char *file, unsigned initial_size);
 bool remove (const char *file);
 int open (const char *file);
@@ -26,168 +33,402 @@ int read (int fd, void *buffer, unsigned size);
 void seek (int fd, unsigned position);
 unsigned tell (int fd);
 void close (int fd);
+int getrusage (int who, struct rusage *usage);
+int settickets (int tickets);
+int setquantum (int ticks);
 tid_t exec (const char *cmdline);
 void exit (int status);
-void get_args_3(struct intr_frame *f, int choose, void *args);
-void get_args_2(struct intr_frame *f, int choose, void *args);
-void get_args_1(struct intr_frame *f, int choose, void *args);
-
 
-void check_valid_ptr (const void *pointer)
+/* Clases de argumento, para validarlos antes de llamar al manejador. */
+enum arg_kind
 {
-    if (!is_user_vaddr(pointer))
-    {
-        exit(-1);
-    }
+    ARG_INT,                    /* Entero, no se valida. */
+    ARG_STR,                    /* Cadena de menos de una pagina. */
+    ARG_INBUF,                  /* Buffer que el kernel lee; el tamaño es
+                                   el argumento siguiente. */
+    ARG_OUTBUF,                 /* Buffer que el kernel escribe; idem. */
+    ARG_PTR                     /* Objeto de ptr_size bytes que el kernel
+                                   lee y escribe. */
+};
+
+/* Maximo numero de argumentos de una llamada. */
+#define ARGS_MAX 4
+
+/* Manejador de una llamada: recibe los argumentos ya validados y
+   devuelve el valor para eax. */
+typedef uint32_t syscall_func (const uint32_t *argv);
+
+/* Descriptor de una llamada al sistema. */
+struct syscall_desc
+{
+    const char *name;           /* Nombre, para el perfil. */
+    syscall_func *func;         /* Manejador. */
+    int arity;                  /* Numero de argumentos. */
+    enum arg_kind args[ARGS_MAX]; /* Clase de cada argumento. */
+    size_t ptr_size;            /* Tamaño del objeto de un ARG_PTR. */
+    uint64_t calls;             /* Veces llamada. */
+    uint64_t cycles;            /* Ciclos en total dentro del kernel. */
+};
+
+static syscall_func sys_halt, sys_exit, sys_exec, sys_wait, sys_create,
+       sys_remove, sys_open, sys_filesize, sys_read, sys_write, sys_seek,
+       sys_tell, sys_close, sys_getrusage, sys_futex_wait, sys_futex_wake,
+       sys_settickets, sys_wait_timeout, sys_setquantum, sys_pread,
+       sys_pwrite, sys_readv, sys_writev;
+
+/* Tabla de llamadas al sistema, indexada por numero de llamada.  Las
+   entradas vacias son llamadas no implementadas. */
+static struct syscall_desc syscalls[] =
+{
+    [SYS_HALT] = {"halt", sys_halt, 0, {}, 0, 0, 0},
+    [SYS_EXIT] = {"exit", sys_exit, 1, {ARG_INT}, 0, 0, 0},
+    [SYS_EXEC] = {"exec", sys_exec, 1, {ARG_STR}, 0, 0, 0},
+    [SYS_WAIT] = {"wait", sys_wait, 1, {ARG_INT}, 0, 0, 0},
+    [SYS_CREATE] = {"create", sys_create, 2, {ARG_STR, ARG_INT}, 0, 0, 0},
+    [SYS_REMOVE] = {"remove", sys_remove, 1, {ARG_STR}, 0, 0, 0},
+    [SYS_OPEN] = {"open", sys_open, 1, {ARG_STR}, 0, 0, 0},
+    [SYS_FILESIZE] = {"filesize", sys_filesize, 1, {ARG_INT}, 0, 0, 0},
+    [SYS_READ] = {"read", sys_read, 3, {ARG_INT, ARG_OUTBUF, ARG_INT}, 0, 0, 0},
+    [SYS_WRITE] = {"write", sys_write, 3, {ARG_INT, ARG_INBUF, ARG_INT}, 0, 0, 0},
+    [SYS_SEEK] = {"seek", sys_seek, 2, {ARG_INT, ARG_INT}, 0, 0, 0},
+    [SYS_TELL] = {"tell", sys_tell, 1, {ARG_INT}, 0, 0, 0},
+    [SYS_CLOSE] = {"close", sys_close, 1, {ARG_INT}, 0, 0, 0},
+    [SYS_GETRUSAGE] = {"getrusage", sys_getrusage, 2, {ARG_INT, ARG_PTR},
+                       sizeof (struct rusage), 0, 0},
+    [SYS_FUTEX_WAIT] = {"futex_wait", sys_futex_wait, 3,
+                        {ARG_PTR, ARG_INT, ARG_INT}, sizeof (int), 0, 0},
+    [SYS_FUTEX_WAKE] = {"futex_wake", sys_futex_wake, 2, {ARG_PTR, ARG_INT},
+                        sizeof (int), 0, 0},
+    [SYS_SETTICKETS] = {"settickets", sys_settickets, 1, {ARG_INT}, 0, 0, 0},
+    [SYS_WAIT_TIMEOUT] = {"wait_timeout", sys_wait_timeout, 3,
+                          {ARG_INT, ARG_INT, ARG_PTR}, sizeof (int), 0, 0},
+    [SYS_SETQUANTUM] = {"setquantum", sys_setquantum, 1, {ARG_INT}, 0, 0, 0},
+    [SYS_PREAD] = {"pread", sys_pread, 4,
+                   {ARG_INT, ARG_OUTBUF, ARG_INT, ARG_INT}, 0, 0, 0},
+    [SYS_PWRITE] = {"pwrite", sys_pwrite, 4,
+                    {ARG_INT, ARG_INBUF, ARG_INT, ARG_INT}, 0, 0, 0},
+    // el iovec lo valida el manejador, ver copy_iov()
+    [SYS_READV] = {"readv", sys_readv, 3, {ARG_INT, ARG_INT, ARG_INT}, 0, 0, 0},
+    [SYS_WRITEV] = {"writev", sys_writev, 3, {ARG_INT, ARG_INT, ARG_INT}, 0, 0, 0},
+};
+
+/* Numero de entradas de la tabla. */
+#define SYSCALL_CNT (sizeof syscalls / sizeof *syscalls)
+
+/* Si es true, syscall_print_stats() imprime el perfil al apagar.
+   Se activa con la opcion "-sysprof" de la linea de comandos. */
+bool syscall_profile;
 
-    void *check = pagedir_get_page(thread_current()->pagedir, pointer);
-    if (check == NULL)
-    {
-        exit(-1);
-    }
-}
 
 void
 syscall_init (void)
 {
     intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
-    lock_init(&file_lock);
+    futex_init();
 }
 
-void get_args_1(struct intr_frame *f, int choose, void *args)
+/* Valida el argumento I de la llamada D, cuyos argumentos son ARGV.
+   Devuelve false si no es valido. */
+static bool
+check_arg (const struct syscall_desc *d, const uint32_t *argv, int i)
 {
-    int argv = *((int*) args);
-    args += 4;
+    void *ptr = (void *) argv[i];
+    int len;
 
-    if (choose == SYS_EXIT)
+    switch (d -> args[i])
     {
-        exit(argv);
+    case ARG_INT:
+        return true;
+    case ARG_STR:
+        len = strnlen_user(ptr, PGSIZE);
+        return len >= 0 && len < PGSIZE;
+    case ARG_INBUF:
+        // el tamaño del buffer es el argumento siguiente
+        return ptr != NULL && user_readable(ptr, argv[i + 1]);
+    case ARG_OUTBUF:
+        return ptr != NULL && user_writable(ptr, argv[i + 1]);
+    case ARG_PTR:
+        return user_writable(ptr, d -> ptr_size);
     }
-    else if (choose == SYS_EXEC)
-    {
-        check_valid_ptr((const void*) argv);
-        f -> eax = exec((const char *)argv);
-    }
-    else if (choose == SYS_WAIT)
+    NOT_REACHED ();
+}
+
+/**
+look up the system call number at the user stack pointer in the
+syscall table, copy its arguments from the user stack and check that
+the user pointers among them are valid, then run its handler and store
+the result in eax
+user memory is read through the accessors in uaccess.c, so checking
+costs one access per page rather than a page table walk per pointer
+unknown system calls and bad pointers kill the process
+*/
+static void
+syscall_handler (struct intr_frame *f )
+{
+    uint64_t start = rdtsc();
+    const uint32_t *esp = f -> esp;
+    uint32_t argv[ARGS_MAX];
+    struct syscall_desc *d;
+    uint32_t syscall_number;
+    int i;
+
+    thread_current() -> usage.syscalls++;
+    if (!copy_from_user(&syscall_number, esp, sizeof syscall_number)
+            || syscall_number >= SYSCALL_CNT
+            || syscalls[syscall_number].func == NULL)
     {
-        f -> eax = wait(argv);
+        exit(-1);
     }
-    else if (choose == SYS_REMOVE)
+    d = &syscalls[syscall_number];
+
+    // validar los argumentos antes de llamar al manejador
+    if (!copy_from_user(argv, esp + 1, d -> arity * sizeof *argv))
     {
-        check_valid_ptr((const void*) argv);
-        f -> eax = remove((const char *) argv);
+        exit(-1);
     }
-    else if(choose == SYS_OPEN)
+    for (i = 0; i < d -> arity; i++)
     {
-        check_valid_ptr((const void*) argv);
-        f -> eax = open((const char *) argv);
+        if (!check_arg(d, argv, i))
+        {
+            exit(-1);
+        }
     }
-    else if (choose == SYS_FILESIZE)
+
+    d -> calls++;
+    f -> eax = d -> func(argv);
+    d -> cycles += rdtsc() - start;
+}
+
+/**
+copy the iovcnt entries of the user array uiov into iov and check
+that every buffer they point to can be written (if writable) or
+read, all before any I/O is done, so a bad buffer anywhere in the
+array kills the process without a partial transfer; entries with
+iov_len 0 move nothing, so their iov_base is not checked
+return false if iovcnt is out of range or the buffers add up to more
+than INT_MAX bytes
+*/
+static bool
+copy_iov (struct iovec *iov, const struct iovec *uiov, int iovcnt,
+          bool writable)
+{
+    size_t total = 0;
+    int i;
+
+    if (iovcnt < 0 || iovcnt > IOV_MAX)
     {
-        f -> eax = filesize(argv);
+        return false;
     }
-    else if (choose == SYS_TELL)
+    if (!copy_from_user(iov, uiov, iovcnt * sizeof *iov))
     {
-        f -> eax = tell(argv);
+        exit(-1);
     }
-    else if (choose == SYS_TELL)
+    for (i = 0; i < iovcnt; i++)
     {
-        close(argv);
+        void *base = iov[i].iov_base;
+        size_t len = iov[i].iov_len;
+
+        // una entrada vacia no mueve bytes, su puntero no importa
+        if (len == 0)
+        {
+            continue;
+        }
+        if (base == NULL
+                || !(writable ? user_writable(base, len)
+                              : user_readable(base, len)))
+        {
+            exit(-1);
+        }
+        total += len;
+        if (total > INT_MAX)
+        {
+            return false;
+        }
     }
+    return true;
 }
 
-void get_args_2(struct intr_frame *f, int choose, void *args)
+/**
+print how many times each system call was made and the cycles spent
+in it, from the trap to the return to user mode, including any time
+blocked, so that slow or hot system calls stand out
+*/
+void
+syscall_print_stats (void)
 {
-    int argv = *((int*) args);
-    args += 4;
-    int argv_1 = *((int*) args);
-    args += 4;
+    unsigned i;
 
-    if (choose == SYS_CREATE)
+    printf ("Syscall profile: calls, total cycles, cycles per call\n");
+    for (i = 0; i < SYSCALL_CNT; i++)
     {
-        check_valid_ptr((const void*) argv);
-        f -> eax = create((const char *) argv, (unsigned) argv_1);
-    }
-    else if(choose == SYS_SEEK)
-    {
-        seek(argv, (unsigned)argv_1);
+        const struct syscall_desc *d = &syscalls[i];
+        if (d -> calls > 0)
+        {
+            printf ("Syscall: %-12s %10"PRIu64" %14"PRIu64" %10"PRIu64"\n",
+                    d -> name, d -> calls, d -> cycles, d -> cycles / d -> calls);
+        }
     }
 }
 
+/* Manejadores de la tabla: convierten los argumentos y llaman a la
+   funcion que implementa cada llamada. */
+
+static uint32_t
+sys_halt (const uint32_t *argv UNUSED)
+{
+    halt();
+    NOT_REACHED ();
+}
+
+static uint32_t
+sys_exit (const uint32_t *argv)
+{
+    exit((int) argv[0]);
+    NOT_REACHED ();
+}
 
-void get_args_3 (struct intr_frame *f, int choose, void *args)
+static uint32_t
+sys_exec (const uint32_t *argv)
 {
-    int argv = *((int*) args);
-    args += 4;
-    int argv_1 = *((int*) args);
-    args += 4;
-    int argv_2 = *((int*) args);
-    args += 4;
+    return exec((const char *) argv[0]);
+}
 
-    check_valid_ptr((const void*) argv_1);
-    void * temp = ((void*) argv_1)+ argv_2 ;
-    check_valid_ptr((const void*) temp);
-    if (choose == SYS_WRITE)
+static uint32_t
+sys_wait (const uint32_t *argv)
+{
+    return wait((tid_t) argv[0]);
+}
+
+static uint32_t
+sys_create (const uint32_t *argv)
+{
+    return create((const char *) argv[0], (unsigned) argv[1]);
+}
+
+static uint32_t
+sys_remove (const uint32_t *argv)
+{
+    return remove((const char *) argv[0]);
+}
+
+static uint32_t
+sys_open (const uint32_t *argv)
+{
+    return open((const char *) argv[0]);
+}
+
+static uint32_t
+sys_filesize (const uint32_t *argv)
+{
+    return filesize((int) argv[0]);
+}
+
+static uint32_t
+sys_read (const uint32_t *argv)
+{
+    return read((int) argv[0], (void *) argv[1], (unsigned) argv[2]);
+}
+
+static uint32_t
+sys_write (const uint32_t *argv)
+{
+    return write((int) argv[0], (const void *) argv[1], (unsigned) argv[2]);
+}
+
+static uint32_t
+sys_seek (const uint32_t *argv)
+{
+    seek((int) argv[0], (unsigned) argv[1]);
+    return 0;
+}
+
+static uint32_t
+sys_tell (const uint32_t *argv)
+{
+    return tell((int) argv[0]);
+}
+
+static uint32_t
+sys_close (const uint32_t *argv)
+{
+    close((int) argv[0]);
+    return 0;
+}
+
+static uint32_t
+sys_getrusage (const uint32_t *argv)
+{
+    return getrusage((int) argv[0], (struct rusage *) argv[1]);
+}
+
+static uint32_t
+sys_futex_wait (const uint32_t *argv)
+{
+    return futex_wait((int *) argv[0], (int) argv[1], (int) argv[2]);
+}
+
+static uint32_t
+sys_futex_wake (const uint32_t *argv)
+{
+    return futex_wake((int *) argv[0], (int) argv[1]);
+}
+
+static uint32_t
+sys_settickets (const uint32_t *argv)
+{
+    return settickets((int) argv[0]);
+}
+
+static uint32_t
+sys_wait_timeout (const uint32_t *argv)
+{
+    return wait_timeout((tid_t) argv[0], (int) argv[1], (int *) argv[2]);
+}
+
+static uint32_t
+sys_setquantum (const uint32_t *argv)
+{
+    return setquantum((int) argv[0]);
+}
+
+static uint32_t
+sys_pread (const uint32_t *argv)
+{
+    return pread((int) argv[0], (void *) argv[1], (unsigned) argv[2],
+                 (int) argv[3]);
+}
+
+static uint32_t
+sys_pwrite (const uint32_t *argv)
+{
+    return pwrite((int) argv[0], (const void *) argv[1], (unsigned) argv[2],
+                  (int) argv[3]);
+}
+
+static uint32_t
+sys_readv (const uint32_t *argv)
+{
+    struct iovec iov[IOV_MAX];
+    int iovcnt = (int) argv[2];
+
+    if (!copy_iov(iov, (const struct iovec *) argv[1], iovcnt, true))
     {
-        f->eax = write (argv,(void *) argv_1,(unsigned) argv_2);
+        return -1;
     }
-    else f->eax = read (argv,(void *) argv_1, (unsigned) argv_2);
+    return readv((int) argv[0], iov, iovcnt);
 }
 
-static void
-syscall_handler (struct intr_frame *f )
+static uint32_t
+sys_writev (const uint32_t *argv)
 {
-    int syscall_number = 0;
-    check_valid_ptr((const void*) f -> esp);
-    void *args = f -> esp;
-    syscall_number = *( (int *) f -> esp);
-    args+=4;
-    check_valid_ptr((const void*) args);
-    switch(syscall_number)
-    {
-    case SYS_HALT:                  	/* Detener el sistema operativo. */
-        halt();
-        break;
-    case SYS_EXIT:                   /* terminar proceso. */
-        get_args_1(f, SYS_EXIT,args);
-        break;
-    case SYS_EXEC:                   /* iniciar proceso. */
-        get_args_1(f, SYS_EXEC,args);
-        break;
-    case SYS_WAIT:                   /* esperar que el proceso hijo muera. */
-        get_args_1(f, SYS_WAIT,args);
-        break;
-    case SYS_CREATE:                 /* crear archivo. */
-        get_args_2(f, SYS_CREATE,args);
-        break;
-    case SYS_REMOVE:                 /* borrar archivo. */
-        get_args_1(f, SYS_REMOVE,args);
-        break;
-    case SYS_OPEN:                   /* abrir archivo. */
-        get_args_1(f, SYS_OPEN,args);
-        break;
-    case SYS_FILESIZE:               /* obtener tamaño del archivo. */
-        get_args_1(f, SYS_FILESIZE,args);
-        break;
-    case SYS_READ:                   /* leer archivo. */
-        get_args_3(f, SYS_READ,args);
-        break;
-    case SYS_WRITE:                  /* escribir archivo. */
-        get_args_3(f, SYS_WRITE,args);
-        break;
-    case SYS_SEEK:                   /* cambiar posicion. */
-        get_args_2(f, SYS_SEEK,args);
-        break;
-    case SYS_TELL:                   /* reportar posicion. */
-        get_args_1(f, SYS_TELL,args);
-        break;
-    case SYS_CLOSE:                  /* cerrar archivo. */
-        get_args_1(f, SYS_CLOSE,args);
-        break;
-    default:
-        exit(-1);
-        break;
+    struct iovec iov[IOV_MAX];
+    int iovcnt = (int) argv[2];
+
+    if (!copy_iov(iov, (const struct iovec *) argv[1], iovcnt, false))
+    {
+        return -1;
     }
+    return writev((int) argv[0], iov, iovcnt);
 }
 
 void halt (void)
@@ -202,17 +443,22 @@ void exit (int status)
     printf ("%s: exit(%d)\n", cur -> name, status);
 
     
-    struct child_element *child = get_child(cur->tid, &cur -> parent -> child_list);
-    
-    child -> exit_status = status;
-    
-    if (status == -1)
+    // la tabla queda bloqueada hasta el ultimo acceso, para que el
+    // padre no pueda liberar el elemento mientras tanto
+    struct child_element *child = thread_lock_child(cur->tid);
+    if (child != NULL)
     {
-        child -> cur_status = WAS_KILLED;
-    }
-    else
-    {
-        child -> cur_status = HAD_EXITED;
+        child -> exit_status = status;
+    
+        if (status == -1)
+        {
+            child -> cur_status = WAS_KILLED;
+        }
+        else
+        {
+            child -> cur_status = HAD_EXITED;
+        }
+        thread_unlock_child();
     }
 
     thread_exit();
@@ -221,15 +467,20 @@ void exit (int status)
 tid_t
 exec (const char *cmd_line)
 {
-    struct thread* parent = thread_current();
     tid_t pid = -1;
     
     pid = process_execute(cmd_line);
 
     
-    struct child_element *child = get_child(pid,&parent -> child_list);
+    struct child_element *child = get_child(pid);
+    if (child == NULL)
+    {
+        return -1;
+    }
     
-    sema_down(&child-> real_child -> sema_exec);
+    // el semaforo esta en el elemento, que es nuestro, no en el hilo
+    // del hijo, que puede haber terminado ya
+    sema_down(&child -> sema_exec);
     
     if(!child -> loaded_success)
     {
@@ -244,49 +495,70 @@ int wait (tid_t pid)
     return process_wait(pid);
 }
 
+/**
+wait for the child pid for at most timeout_ms milliseconds, or forever if
+timeout_ms is negative
+return WAIT_EXITED with the exit status in *status, WAIT_TIMEOUT or -1
+*/
+int wait_timeout (tid_t pid, int timeout_ms, int *status)
+{
+    int64_t timeout = -1;
+    int exit_status;
+    int result;
+
+    if (timeout_ms >= 0)
+    {
+        timeout = DIV_ROUND_UP((int64_t) timeout_ms * TIMER_FREQ, 1000);
+    }
+    result = process_wait_timeout(pid, timeout, &exit_status);
+    if (result == WAIT_EXITED)
+    {
+        *status = exit_status;
+    }
+    return result;
+}
+
+/* El sistema de archivos hace su propio bloqueo (un lock por inodo,
+   uno por directorio y uno para el mapa libre), asi que las llamadas
+   de archivos no toman ningun lock aqui. */
+
 bool create (const char *file, unsigned initial_size)
 {
-    lock_acquire(&file_lock);
     bool ret = filesys_create(file, initial_size);
-    lock_release(&file_lock);
     return ret;
 }
 
 bool remove (const char *file)
 {
-    lock_acquire(&file_lock);
     bool ret = filesys_remove(file);
-    lock_release(&file_lock);
     return ret;
 }
 
 int open (const char *file)
 {
     int ret = -1;
-    lock_acquire(&file_lock);
     struct thread *cur = thread_current ();
     struct file * opened_file = filesys_open(file);
-    lock_release(&file_lock);
     if(opened_file != NULL)
     {
-        cur->fd_size = cur->fd_size + 1;
-        ret = cur->fd_size;
-        /*create and init new fd_element*/
-        struct fd_element *file_d = (struct fd_element*) malloc(sizeof(struct fd_element));
-        file_d->fd = ret;
-        file_d->myfile = opened_file;
-        
-        list_push_back(&cur->fd_list, &file_d->element);
+        // el descriptor libre mas bajo
+        ret = fd_table_add(&cur->fds, opened_file);
+        if (ret < 0)
+        {
+            file_close(opened_file);
+        }
     }
     return ret;
 }
 
 int filesize (int fd)
 {
-    struct file *myfile = get_fd(fd)->myfile;
-    lock_acquire(&file_lock);
+    struct file *myfile = get_file(fd);
+    if(myfile == NULL)
+    {
+        return -1;
+    }
     int ret = file_length(myfile);
-    lock_release(&file_lock);
     return ret;
 }
 
@@ -301,16 +573,13 @@ int read (int fd, void *buffer, unsigned size)
     else if(fd > 0)
     {
         
-        struct fd_element *fd_elem = get_fd(fd);
-        if(fd_elem == NULL || buffer == NULL)
+        struct file *myfile = get_file(fd);
+        if(myfile == NULL || buffer == NULL)
         {
             return -1;
         }
         
-        struct file *myfile = fd_elem->myfile;
-        lock_acquire(&file_lock);
         ret = file_read(myfile, buffer, size);
-        lock_release(&file_lock);
         if(ret < (int)size && ret != 0)
         {
             
@@ -333,16 +602,13 @@ int write (int fd, const void *buffer_, unsigned size)
     else
     {
         
-        struct fd_element *fd_elem = get_fd(fd);
-        if(fd_elem == NULL || buffer_ == NULL )
+        struct file *myfile = get_file(fd);
+        if(myfile == NULL || buffer_ == NULL )
         {
             return -1;
         }
         
-        struct file *myfile = fd_elem->myfile;
-        lock_acquire(&file_lock);
         ret = file_write(myfile, buffer_, size);
-        lock_release(&file_lock);
     }
     return ret;
 }
@@ -350,95 +616,250 @@ int write (int fd, const void *buffer_, unsigned size)
 
 void seek (int fd, unsigned position)
 {
-    struct fd_element *fd_elem = get_fd(fd);
-    if(fd_elem == NULL)
+    struct file *myfile = get_file(fd);
+    if(myfile == NULL)
     {
         return;
     }
-    struct file *myfile = fd_elem->myfile;
-    lock_acquire(&file_lock);
     file_seek(myfile,position);
-    lock_release(&file_lock);
 }
 
 unsigned tell (int fd)
 {
-    struct fd_element *fd_elem = get_fd(fd);
-    if(fd_elem == NULL)
+    struct file *myfile = get_file(fd);
+    if(myfile == NULL)
     {
         return -1;
     }
-    struct file *myfile = fd_elem->myfile;
-    lock_acquire(&file_lock);
     unsigned ret = file_tell(myfile);
-    lock_release(&file_lock);
     return ret;
 }
 
 void close (int fd)
 {
-    struct fd_element *fd_elem = get_fd(fd);
-    if(fd_elem == NULL)
+    // el descriptor queda libre para el proximo open
+    struct file *myfile = fd_table_remove(&thread_current()->fds, fd);
+    if(myfile == NULL)
     {
         return;
     }
-    struct file *myfile = fd_elem->myfile;
-    lock_acquire(&file_lock);
     file_close(myfile);
-    lock_release(&file_lock);
 }
 
 /**
-close and free all file the current thread have
+read size bytes from the file open as fd into buffer, starting at
+byte offset of the file, in one call and without moving the file
+position
+return the number of bytes read, which is less than size at end of
+file, or -1 if fd is not an open file or offset is negative
+*/
+int pread (int fd, void *buffer, unsigned size, int offset)
+{
+    struct file *myfile = get_file(fd);
+    if(myfile == NULL || offset < 0)
+    {
+        return -1;
+    }
+    return file_read_at(myfile, buffer, size, offset);
+}
+
+/**
+write size bytes from buffer to the file open as fd, starting at
+byte offset of the file, in one call and without moving the file
+position
+return the number of bytes written, or -1 if fd is not an open file
+or offset is negative
+*/
+int pwrite (int fd, const void *buffer, unsigned size, int offset)
+{
+    struct file *myfile = get_file(fd);
+    if(myfile == NULL || offset < 0)
+    {
+        return -1;
+    }
+    return file_write_at(myfile, buffer, size, offset);
+}
+
+/**
+read from the file open as fd into the iovcnt buffers of iov in turn,
+starting at the file position, and advance the position past the
+bytes read; iov has already been copied in and checked by copy_iov()
+return the number of bytes read, or -1 if fd is not an open file
 */
-void close_all(struct list *fd_list)
+int readv (int fd, const struct iovec *iov, int iovcnt)
 {
-    struct list_elem *e;
-    while(!list_empty(fd_list))
+    struct file *myfile = get_file(fd);
+    off_t pos;
+    int total = 0;
+    int i;
+
+    if(myfile == NULL)
+    {
+        return -1;
+    }
+    pos = file_tell(myfile);
+    for (i = 0; i < iovcnt; i++)
     {
-        e = list_pop_front(fd_list);
-        struct fd_element *fd_elem = list_entry (e, struct fd_element, element);
-        file_close(fd_elem->myfile);
-        list_remove(e);
-        free(fd_elem);
+        off_t n = file_read_at(myfile, iov[i].iov_base, iov[i].iov_len,
+                               pos + total);
+        total += n;
+        // fin de archivo
+        if (n < (off_t) iov[i].iov_len)
+        {
+            break;
+        }
     }
+    file_seek(myfile, pos + total);
+    return total;
 }
 
 /**
- * iterate on the fd_list of the cuttrnt thread and get the file which
- * have the same fd
- * if nou found retuen NULL
- * */
-struct fd_element*
-get_fd(int fd)
-{
-    struct list_elem *e;
-    for (e = list_begin (&thread_current()->fd_list); e != list_end (&thread_current()->fd_list);
-            e = list_next (e))
-    {
-        struct fd_element *fd_elem = list_entry (e, struct fd_element, element);
-        if(fd_elem->fd == fd)
+write the iovcnt buffers of iov in turn to the file open as fd,
+starting at the file position, and advance the position past the
+bytes written; fd 1 writes them to the console
+iov has already been copied in and checked by copy_iov()
+return the number of bytes written, or -1 if fd is not an open file
+*/
+int writev (int fd, const struct iovec *iov, int iovcnt)
+{
+    struct file *myfile;
+    off_t pos;
+    int total = 0;
+    int i;
+
+    if (fd == 1)
+    {
+        for (i = 0; i < iovcnt; i++)
         {
-            return fd_elem;
+            putbuf(iov[i].iov_base, iov[i].iov_len);
+            total += iov[i].iov_len;
         }
+        return total;
+    }
+
+    myfile = get_file(fd);
+    if(myfile == NULL)
+    {
+        return -1;
     }
-    return NULL;
+    pos = file_tell(myfile);
+    for (i = 0; i < iovcnt; i++)
+    {
+        off_t n = file_write_at(myfile, iov[i].iov_base, iov[i].iov_len,
+                                pos + total);
+        total += n;
+        // fin de archivo o escritura denegada
+        if (n < (off_t) iov[i].iov_len)
+        {
+            break;
+        }
+    }
+    file_seek(myfile, pos + total);
+    return total;
 }
 
+/**
+copy the resource usage of the current process (RUSAGE_SELF) or
+of its waited-for children (RUSAGE_CHILDREN) into usage
+return 0 on success, -1 if who is not valid
+*/
+int getrusage (int who, struct rusage *usage)
+{
+    struct thread *cur = thread_current();
+    struct rusage r;
+    enum intr_level old_level;
+
+    /*the tick counters are updated by the timer interrupt*/
+    old_level = intr_disable();
+    if (who == RUSAGE_SELF)
+    {
+        r = cur -> usage;
+    }
+    else if (who == RUSAGE_CHILDREN)
+    {
+        r = cur -> child_usage;
+    }
+    else
+    {
+        intr_set_level(old_level);
+        return -1;
+    }
+    intr_set_level(old_level);
+
+    *usage = r;
+    return 0;
+}
 
 /**
-intrate on mylist and return the child which have the tid
+set the tickets of the current thread for the stride scheduler
+return 0 on success, -1 if tickets is out of range
 */
-struct child_element*
-get_child(tid_t tid, struct list *mylist)
+int settickets (int tickets)
 {
-    struct list_elem* e;
-    for (e = list_begin (mylist); e != list_end (mylist); e = list_next (e))
+    if (tickets < TICKETS_MIN || tickets > TICKETS_MAX)
     {
-        struct child_element *child = list_entry (e, struct child_element, child_elem);
-        if(child -> child_pid == tid)
+        return -1;
+    }
+    thread_set_tickets(tickets);
+    return 0;
+}
+
+/**
+set the time slice of the current thread to ticks timer ticks,
+0 goes back to the default given with -slice
+return 0 on success, -1 if ticks is out of range
+*/
+int setquantum (int ticks)
+{
+    if (ticks < 0 || ticks > SLICE_MAX)
+    {
+        return -1;
+    }
+    thread_set_quantum(ticks);
+    return 0;
+}
+
+/**
+close all files the current thread has open and free its fd table
+*/
+void close_all(void)
+{
+    struct fd_table *fds = &thread_current()->fds;
+    int fd;
+
+    for (fd = FD_MIN; fd < fd_table_end(fds); fd++)
+    {
+        struct file *myfile = fd_table_remove(fds, fd);
+        if (myfile != NULL)
         {
-            return child;
+            file_close(myfile);
         }
     }
+    fd_table_destroy(fds);
+}
+
+/**
+return the file the current thread has open as fd, or NULL if fd is
+not open
+*/
+static struct file *
+get_file(int fd)
+{
+    return fd_table_get(&thread_current()->fds, fd);
+}
+
+
+/**
+return the child of the current thread which have the tid,
+or NULL if tid is not a child of the current thread
+*/
+struct child_element*
+get_child(tid_t tid)
+{
+    struct child_element *child = thread_get_child(tid);
+    if(child == NULL || child -> parent_tid != thread_tid())
+    {
+        return NULL;
+    }
+    return child;
 }
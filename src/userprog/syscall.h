@@ -5,19 +5,14 @@
 #include "threads/thread.h"
 #include <list.h>
 #include "threads/synch.h"
+#include <uio.h>
 
-
-struct lock file_lock;       
-
-struct fd_element
-{
-    int fd;                        //ID de descriptores de archivos
-    struct file *myfile;           //El archivo real
-    struct list_elem element;      //lista de elementos para agregar fd_element en fd_list
-};
+/*si es true se imprime el perfil de llamadas al apagar (opcion "-sysprof")*/
+extern bool syscall_profile;
 
 
 void syscall_init (void);
+void syscall_print_stats (void);
 void halt (void);
 void exit (int status);
 tid_t exec (const char *cmd_line);
@@ -31,9 +26,14 @@ int write (int fd, const void *buffer, unsigned size);
 void seek (int fd, unsigned position);
 unsigned tell (int fd);
 void close (int fd);
-
-void close_all(struct list * fd_list);
-struct child_element* get_child(tid_t tid,struct list *mylist);
+int getrusage (int who, struct rusage *usage);
+int pread (int fd, void *buffer, unsigned size, int offset);
+int pwrite (int fd, const void *buffer, unsigned size, int offset);
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+
+void close_all(void);
+struct child_element* get_child(tid_t tid);
 
 
 #endif /* userprog/syscall.h */
@@ -0,0 +1,204 @@
+#include "userprog/uaccess.h"
+#include <debug.h>
+#include "threads/vaddr.h"
+
+/* Access to user memory.
+
+   The functions here read and write user memory directly, without
+   first asking the page directory whether it is mapped.  Each
+   instruction that touches user memory is listed in the exception
+   table, section __ex_table, next to the address of fixup code.
+   If one of them faults, page_fault() finds it with
+   uaccess_fixup() and resumes at the fixup code, which makes the
+   function return failure.  So an access to valid memory costs no
+   more than the access itself, and a buffer is checked in full
+   however many pages it spans.
+
+   Kernel addresses are always mapped, so they would not fault.
+   Every function therefore first checks that the whole range it
+   was given lies below PHYS_BASE. */
+
+/* An exception table entry. */
+struct ex_entry
+  {
+    uintptr_t insn;             /* Instruction that may fault. */
+    uintptr_t fixup;            /* Where to resume if it does. */
+  };
+
+/* The exception table, gathered by the linker script. */
+extern const struct ex_entry __start_ex_table[], __stop_ex_table[];
+
+/* Makes the instruction at local label 1 resume at local label 3
+   if it faults. */
+#define EX_TABLE_ENTRY                          \
+        ".section __ex_table, \"a\"\n"          \
+        "        .long 1b, 3b\n"                \
+        ".previous\n"
+
+/* Returns true if SIZE bytes starting at user address UADDR lie
+   entirely below PHYS_BASE. */
+static bool
+is_user_range (const void *uaddr, size_t size) 
+{
+  uintptr_t start = (uintptr_t) uaddr;
+
+  return start + size >= start && start + size <= (uintptr_t) PHYS_BASE;
+}
+
+/* Reads a byte at user virtual address UADDR.
+   Returns the byte value if successful, -1 if UADDR is not
+   mapped or is not a user address. */
+int
+get_user (const uint8_t *uaddr) 
+{
+  int result;
+
+  if (!is_user_range (uaddr, 1))
+    return -1;
+  asm volatile ("1:      movzbl %1, %0\n"
+                "2:\n"
+                ".section .fixup, \"ax\"\n"
+                "3:      movl $-1, %0\n"
+                "        jmp 2b\n"
+                ".previous\n"
+                EX_TABLE_ENTRY
+                : "=r" (result) : "m" (*uaddr));
+  return result;
+}
+
+/* Writes BYTE to user address UDST.
+   Returns true if successful, false if UDST is not mapped
+   writable or is not a user address. */
+bool
+put_user (uint8_t *udst, uint8_t byte) 
+{
+  int error = 0;
+
+  if (!is_user_range (udst, 1))
+    return false;
+  asm volatile ("1:      movb %b2, %1\n"
+                "2:\n"
+                ".section .fixup, \"ax\"\n"
+                "3:      movl $-1, %0\n"
+                "        jmp 2b\n"
+                ".previous\n"
+                EX_TABLE_ENTRY
+                : "+r" (error), "=m" (*udst) : "q" (byte));
+  return error == 0;
+}
+
+/* Copies SIZE bytes from SRC to DST, either of which may be in
+   user memory, which the caller has checked.  Returns true if
+   successful, false if a page fault interrupted the copy, in
+   which case part of DST may have been written. */
+static bool
+copy_bytes (void *dst, const void *src, size_t size) 
+{
+  int error = 0;
+
+  asm volatile ("1:      rep movsb\n"
+                "2:\n"
+                ".section .fixup, \"ax\"\n"
+                "3:      movl $-1, %0\n"
+                "        jmp 2b\n"
+                ".previous\n"
+                EX_TABLE_ENTRY
+                : "+r" (error), "+D" (dst), "+S" (src), "+c" (size)
+                : : "memory");
+  return error == 0;
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address
+   DST.  Returns true if successful, false if any of the source
+   bytes is not mapped user memory. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size) 
+{
+  return is_user_range (usrc, size) && copy_bytes (dst, usrc, size);
+}
+
+/* Copies SIZE bytes from kernel address SRC to user address
+   UDST.  Returns true if successful, false if any of the
+   destination bytes is not mapped writable user memory. */
+bool
+copy_to_user (void *udst, const void *src, size_t size) 
+{
+  return is_user_range (udst, size) && copy_bytes (udst, src, size);
+}
+
+/* Returns the length of the null-terminated string at user
+   address USTR, MAX if none of its first MAX bytes is a null
+   character, or -1 if a byte before that is not mapped user
+   memory. */
+int
+strnlen_user (const char *ustr, size_t max) 
+{
+  const uint8_t *p = (const uint8_t *) ustr;
+  size_t len;
+
+  ASSERT (max <= INT32_MAX);
+
+  for (len = 0; len < max; len++) 
+    {
+      int c = get_user (p + len);
+      if (c < 0)
+        return -1;
+      else if (c == 0)
+        break;
+    }
+  return len;
+}
+
+/* Returns true if the SIZE bytes at user address UADDR are all
+   mapped user memory.  Reads one byte of each page. */
+bool
+user_readable (const void *uaddr, size_t size) 
+{
+  const uint8_t *p = uaddr;
+  const uint8_t *end = p + size;
+
+  if (size == 0)
+    return true;
+  if (!is_user_range (uaddr, size))
+    return false;
+  for (; p < end; p = (const uint8_t *) pg_round_down (p) + PGSIZE)
+    if (get_user (p) < 0)
+      return false;
+  return true;
+}
+
+/* Returns true if the SIZE bytes at user address UADDR are all
+   mapped writable user memory.  Rewrites one byte of each page
+   with its own value. */
+bool
+user_writable (void *uaddr, size_t size) 
+{
+  uint8_t *p = uaddr;
+  uint8_t *end = p + size;
+
+  if (size == 0)
+    return true;
+  if (!is_user_range (uaddr, size))
+    return false;
+  for (; p < end; p = (uint8_t *) pg_round_down (p) + PGSIZE) 
+    {
+      int c = get_user (p);
+      if (c < 0 || !put_user (p, c))
+        return false;
+    }
+  return true;
+}
+
+/* If EIP is an instruction listed in the exception table, returns
+   the address of its fixup code, otherwise a null pointer.
+   Called by page_fault() for faults in kernel code. */
+void *
+uaccess_fixup (const void *eip) 
+{
+  const struct ex_entry *e;
+
+  for (e = __start_ex_table; e < __stop_ex_table; e++)
+    if (e->insn == (uintptr_t) eip)
+      return (void *) e->fixup;
+  return NULL;
+}
@@ -0,0 +1,18 @@
+#ifndef USERPROG_UACCESS_H
+#define USERPROG_UACCESS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+int get_user (const uint8_t *uaddr);
+bool put_user (uint8_t *udst, uint8_t byte);
+bool copy_from_user (void *dst, const void *usrc, size_t size);
+bool copy_to_user (void *udst, const void *src, size_t size);
+int strnlen_user (const char *ustr, size_t max);
+bool user_readable (const void *uaddr, size_t size);
+bool user_writable (void *uaddr, size_t size);
+
+void *uaccess_fixup (const void *eip);
+
+#endif /**< userprog/uaccess.h */